@@ -0,0 +1,134 @@
+// copy_propagation.c
+#include "headers/copy_propagation.h"
+
+static void *copy_alloc(size_t size)
+{
+    void *p = calloc(1, size > 0 ? size : 1);
+    if (!p)
+    {
+        fprintf(stderr, "Memory allocation failed in copy propagation\n");
+        exit(1);
+    }
+    return p;
+}
+
+// === COPY PROPAGATION ===
+int copy_propagate(TACInstruction *code, int *count)
+{
+    int n = *count;
+    if (n == 0)
+        return 0;
+
+    SSAForm ssa = ssa_build(code, n);
+    int nids = dataflow_id_count(&ssa.ids);
+
+    int *root = copy_alloc(sizeof(int) * ssa.value_count); // oldest value each copies
+    int *current = copy_alloc(sizeof(int) * (nids > 0 ? nids : 1));
+    for (int v = 0; v < ssa.value_count; v++)
+    {
+        root[v] = v;
+        if (ssa.values[v].def == SSA_ENTRY_DEF)
+            current[ssa.values[v].id] = v;
+    }
+
+    int rewritten = 0;
+    for (int i = 0; i < n; i++)
+    {
+        TACOperand *args[2] = {&code[i].arg1, &code[i].arg2};
+        for (int k = 0; k < 2; k++)
+        {
+            int use = ssa.use_value[i][k];
+            if (use < 0)
+                continue;
+
+            // the source must not have been redefined since the copy
+            int r = root[use];
+            if (r != use && current[ssa.values[r].id] == r)
+            {
+                *args[k] = dataflow_id_operand(&ssa.ids, ssa.values[r].id);
+                rewritten++;
+            }
+        }
+
+        int def = ssa.def_value[i];
+        if (def < 0)
+            continue;
+        if (code[i].op == TAC_COPY && ssa.use_value[i][0] >= 0)
+            root[def] = root[ssa.use_value[i][0]];
+        current[ssa.values[def].id] = def;
+    }
+
+    free(root);
+    free(current);
+    ssa_free(&ssa);
+    return rewritten;
+}
+
+// === COPY COALESCING ===
+int coalesce_copies(TACInstruction *code, int *count)
+{
+    int n = *count;
+    if (n == 0)
+        return 0;
+
+    DataflowIdSpace ids = dataflow_id_space(code, n);
+    int nids = dataflow_id_count(&ids);
+
+    int *reads = copy_alloc(sizeof(int) * (nids > 0 ? nids : 1));
+    int *def_at = copy_alloc(sizeof(int) * (nids > 0 ? nids : 1));
+    int *last_ref = copy_alloc(sizeof(int) * (nids > 0 ? nids : 1));
+    for (int id = 0; id < nids; id++)
+        def_at[id] = last_ref[id] = -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        int uses[2];
+        int u = dataflow_use_ids(&ids, &code[i], uses);
+        for (int k = 0; k < u; k++)
+            reads[uses[k]]++;
+    }
+
+    int removed = 0;
+    for (int i = 0; i < n; i++)
+    {
+        TACInstruction *ins = &code[i];
+        int src = dataflow_operand_id(&ids, ins->arg1);
+        int dst = dataflow_def_id(&ids, ins);
+
+        if (ins->op == TAC_COPY && tac_is_temp(ins->arg1) && dst >= 0 && dst != src &&
+            reads[src] == 1 && def_at[src] >= 0 && last_ref[dst] <= def_at[src])
+        {
+            // operands are read before the result is written, so the
+            // defining instruction may itself read dst
+            int d = def_at[src];
+            code[d].result = ins->result;
+            def_at[dst] = d;
+            last_ref[dst] = d;
+            def_at[src] = -1;
+            ins->result = TAC_NO_OPERAND;
+            removed++;
+            continue;
+        }
+
+        int uses[2];
+        int u = dataflow_use_ids(&ids, ins, uses);
+        for (int k = 0; k < u; k++)
+            last_ref[uses[k]] = i;
+        if (dst >= 0)
+        {
+            last_ref[dst] = i;
+            def_at[dst] = i;
+        }
+    }
+
+    int j = 0;
+    for (int i = 0; i < n; i++)
+        if (code[i].result != TAC_NO_OPERAND)
+            code[j++] = code[i];
+    *count = j;
+
+    free(reads);
+    free(def_at);
+    free(last_ref);
+    return removed;
+}
@@ -0,0 +1,427 @@
+// dataflow.c
+#include "headers/dataflow.h"
+
+// === BIT SETS ===
+BitSet bitset_create(int nbits)
+{
+    BitSet set;
+    set.nbits = nbits;
+    set.nwords = (nbits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    set.words = calloc(set.nwords > 0 ? set.nwords : 1, sizeof(BitWord));
+    if (!set.words)
+    {
+        fprintf(stderr, "Memory allocation failed in bitset_create()\n");
+        exit(1);
+    }
+    return set;
+}
+
+void bitset_free(BitSet *set)
+{
+    free(set->words);
+    set->words = NULL;
+    set->nbits = set->nwords = 0;
+}
+
+void bitset_clear_all(BitSet *set)
+{
+    memset(set->words, 0, sizeof(BitWord) * set->nwords);
+}
+
+void bitset_fill(BitSet *set)
+{
+    memset(set->words, 0xFF, sizeof(BitWord) * set->nwords);
+
+    // keep the bits past nbits clear so counting and comparing stay exact
+    int tail = set->nbits % BITS_PER_WORD;
+    if (tail)
+        set->words[set->nwords - 1] = (1ULL << tail) - 1;
+}
+
+void bitset_set(BitSet *set, int bit)
+{
+    set->words[bit / BITS_PER_WORD] |= 1ULL << (bit % BITS_PER_WORD);
+}
+
+void bitset_reset(BitSet *set, int bit)
+{
+    set->words[bit / BITS_PER_WORD] &= ~(1ULL << (bit % BITS_PER_WORD));
+}
+
+int bitset_test(const BitSet *set, int bit)
+{
+    if (bit < 0 || bit >= set->nbits)
+        return 0;
+    return (set->words[bit / BITS_PER_WORD] >> (bit % BITS_PER_WORD)) & 1;
+}
+
+void bitset_copy(BitSet *dst, const BitSet *src)
+{
+    memcpy(dst->words, src->words, sizeof(BitWord) * dst->nwords);
+}
+
+// returns 1 if dst changed
+int bitset_union_into(BitSet *dst, const BitSet *src)
+{
+    BitWord changed = 0;
+    for (int i = 0; i < dst->nwords; i++)
+    {
+        BitWord merged = dst->words[i] | src->words[i];
+        changed |= merged ^ dst->words[i];
+        dst->words[i] = merged;
+    }
+    return changed != 0;
+}
+
+// returns 1 if dst changed
+int bitset_intersect_into(BitSet *dst, const BitSet *src)
+{
+    BitWord changed = 0;
+    for (int i = 0; i < dst->nwords; i++)
+    {
+        BitWord merged = dst->words[i] & src->words[i];
+        changed |= merged ^ dst->words[i];
+        dst->words[i] = merged;
+    }
+    return changed != 0;
+}
+
+void bitset_subtract(BitSet *dst, const BitSet *src)
+{
+    for (int i = 0; i < dst->nwords; i++)
+        dst->words[i] &= ~src->words[i];
+}
+
+int bitset_equals(const BitSet *a, const BitSet *b)
+{
+    return memcmp(a->words, b->words, sizeof(BitWord) * a->nwords) == 0;
+}
+
+int bitset_count(const BitSet *set)
+{
+    int total = 0;
+    for (int i = 0; i < set->nwords; i++)
+        total += __builtin_popcountll(set->words[i]);
+    return total;
+}
+
+// === OPERAND IDS ===
+DataflowIdSpace dataflow_id_space(const TACInstruction *code, int count)
+{
+    DataflowIdSpace ids;
+    ids.var_count = symbol_count;
+    ids.temp_count = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const TACOperand operands[3] = {code[i].result, code[i].arg1, code[i].arg2};
+        for (int k = 0; k < 3; k++)
+            if (tac_is_temp(operands[k]) && tac_index(operands[k]) >= ids.temp_count)
+                ids.temp_count = tac_index(operands[k]) + 1;
+    }
+    return ids;
+}
+
+int dataflow_id_count(const DataflowIdSpace *ids)
+{
+    return ids->var_count + ids->temp_count;
+}
+
+// returns the bit index of a variable or temporary, -1 for constants
+int dataflow_operand_id(const DataflowIdSpace *ids, TACOperand operand)
+{
+    if (tac_is_temp(operand))
+        return ids->var_count + tac_index(operand);
+    if (tac_is_var(operand) && tac_index(operand) < ids->var_count)
+        return tac_index(operand);
+    return -1;
+}
+
+// inverse of dataflow_operand_id
+TACOperand dataflow_id_operand(const DataflowIdSpace *ids, int id)
+{
+    return id < ids->var_count ? tac_var(id) : tac_temp(id - ids->var_count);
+}
+
+int dataflow_def_id(const DataflowIdSpace *ids, const TACInstruction *ins)
+{
+    return dataflow_operand_id(ids, ins->result);
+}
+
+// stores the ids read by the instruction in uses[], returns how many
+int dataflow_use_ids(const DataflowIdSpace *ids, const TACInstruction *ins, int uses[2])
+{
+    int n = 0;
+    int a = dataflow_operand_id(ids, ins->arg1);
+    int b = dataflow_operand_id(ids, ins->arg2);
+    if (a >= 0)
+        uses[n++] = a;
+    if (b >= 0)
+        uses[n++] = b;
+    return n;
+}
+
+// === GENERIC SOLVER ===
+static BitSet *bitset_array(int count, int nbits)
+{
+    BitSet *sets = malloc(sizeof(BitSet) * (count > 0 ? count : 1));
+    if (!sets)
+    {
+        fprintf(stderr, "Memory allocation failed in bitset_array()\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++)
+        sets[i] = bitset_create(nbits);
+    return sets;
+}
+
+static void free_bitset_array(BitSet *sets, int count)
+{
+    if (!sets)
+        return;
+    for (int i = 0; i < count; i++)
+        bitset_free(&sets[i]);
+    free(sets);
+}
+
+void dataflow_init_problem(DataflowProblem *p, DataflowDirection dir, DataflowMeet meet, int node_count, int nbits)
+{
+    memset(p, 0, sizeof(*p));
+    p->direction = dir;
+    p->meet = meet;
+    p->node_count = node_count;
+    p->nbits = nbits;
+    p->gen = bitset_array(node_count, nbits);
+    p->kill = bitset_array(node_count, nbits);
+    p->boundary = bitset_create(nbits);
+    p->in = bitset_array(node_count, nbits);
+    p->out = bitset_array(node_count, nbits);
+}
+
+void dataflow_free_problem(DataflowProblem *p)
+{
+    free_bitset_array(p->gen, p->node_count);
+    free_bitset_array(p->kill, p->node_count);
+    free_bitset_array(p->in, p->node_count);
+    free_bitset_array(p->out, p->node_count);
+    bitset_free(&p->boundary);
+    memset(p, 0, sizeof(*p));
+}
+
+/* Edges the solver walks against the analysis direction ("sources" feed a
+   node's input) and along it ("sinks" are revisited when its output changes). */
+static int edge_range(const int *start, int node, int node_count, int implicit_neighbour, int *first, int *last)
+{
+    if (start)
+    {
+        *first = start[node];
+        *last = start[node + 1];
+        return 1;
+    }
+    // straight-line: a single implicit neighbour, if it exists
+    *first = 0;
+    *last = (implicit_neighbour >= 0 && implicit_neighbour < node_count) ? 1 : 0;
+    return 0;
+}
+
+void dataflow_solve(DataflowProblem *p)
+{
+    int n = p->node_count;
+    if (n == 0)
+        return;
+
+    int forward = p->direction == DATAFLOW_FORWARD;
+
+    // "entry" holds the meet of the incoming facts, "exit" the transfer result
+    BitSet *entry = forward ? p->in : p->out;
+    BitSet *exit_ = forward ? p->out : p->in;
+    const int *src_start = forward ? p->pred_start : p->succ_start;
+    const int *srcs = forward ? p->preds : p->succs;
+    const int *sink_start = forward ? p->succ_start : p->pred_start;
+    const int *sinks = forward ? p->succs : p->preds;
+
+    // optimistic start: empty for may-problems, everything for must-problems
+    for (int i = 0; i < n; i++)
+    {
+        if (p->meet == DATAFLOW_INTERSECT)
+            bitset_fill(&exit_[i]);
+        else
+            bitset_clear_all(&exit_[i]);
+    }
+
+    int *worklist = malloc(sizeof(int) * n);
+    char *queued = calloc(n, 1);
+    if (!worklist || !queued)
+    {
+        fprintf(stderr, "Memory allocation failed in dataflow_solve()\n");
+        exit(1);
+    }
+
+    // seed in analysis order so a straight line converges in one sweep
+    int head = 0, size = n;
+    for (int i = 0; i < n; i++)
+    {
+        worklist[i] = forward ? i : n - 1 - i;
+        queued[i] = 1;
+    }
+
+    BitSet scratch = bitset_create(p->nbits);
+
+    while (size > 0)
+    {
+        int node = worklist[head];
+        head = (head + 1) % n;
+        size--;
+        queued[node] = 0;
+
+        // meet over incoming edges
+        int first, last;
+        int explicit_edges = edge_range(src_start, node, n, forward ? node - 1 : node + 1, &first, &last);
+        if (first == last)
+            bitset_copy(&entry[node], &p->boundary);
+        else
+        {
+            for (int e = first; e < last; e++)
+            {
+                int src = explicit_edges ? srcs[e] : (forward ? node - 1 : node + 1);
+                if (e == first)
+                    bitset_copy(&entry[node], &exit_[src]);
+                else if (p->meet == DATAFLOW_UNION)
+                    bitset_union_into(&entry[node], &exit_[src]);
+                else
+                    bitset_intersect_into(&entry[node], &exit_[src]);
+            }
+        }
+
+        // transfer: exit = gen | (entry - kill)
+        bitset_copy(&scratch, &entry[node]);
+        bitset_subtract(&scratch, &p->kill[node]);
+        bitset_union_into(&scratch, &p->gen[node]);
+
+        if (bitset_equals(&scratch, &exit_[node]))
+            continue;
+        bitset_copy(&exit_[node], &scratch);
+
+        explicit_edges = edge_range(sink_start, node, n, forward ? node + 1 : node - 1, &first, &last);
+        for (int e = first; e < last; e++)
+        {
+            int sink = explicit_edges ? sinks[e] : (forward ? node + 1 : node - 1);
+            if (!queued[sink])
+            {
+                queued[sink] = 1;
+                worklist[(head + size) % n] = sink;
+                size++;
+            }
+        }
+    }
+
+    bitset_free(&scratch);
+    free(worklist);
+    free(queued);
+}
+
+// === ANALYSES OVER TAC ===
+static DataflowResult take_result(DataflowProblem *p, DataflowIdSpace ids)
+{
+    DataflowResult r;
+    r.count = p->node_count;
+    r.ids = ids;
+    r.in = p->in;
+    r.out = p->out;
+
+    // the caller owns in/out now
+    p->in = NULL;
+    p->out = NULL;
+    dataflow_free_problem(p);
+    return r;
+}
+
+/* Backward: a value is live after an instruction if a later instruction reads
+   it before redefining it. Variables can be made live at exit because their
+   final values are what the program leaves behind in .data. */
+DataflowResult dataflow_liveness(const TACInstruction *code, int count, int variables_live_at_exit)
+{
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    DataflowProblem p;
+    dataflow_init_problem(&p, DATAFLOW_BACKWARD, DATAFLOW_UNION, count, dataflow_id_count(&ids));
+
+    for (int i = 0; i < count; i++)
+    {
+        int uses[2];
+        int n = dataflow_use_ids(&ids, &code[i], uses);
+        for (int k = 0; k < n; k++)
+            bitset_set(&p.gen[i], uses[k]);
+
+        int def = dataflow_def_id(&ids, &code[i]);
+        if (def >= 0)
+            bitset_set(&p.kill[i], def);
+    }
+
+    if (variables_live_at_exit)
+        for (int v = 0; v < ids.var_count; v++)
+            bitset_set(&p.boundary, v);
+
+    dataflow_solve(&p);
+    return take_result(&p, ids);
+}
+
+/* Forward must-problem: a variable is definitely assigned before an
+   instruction if every path to it writes the variable. */
+DataflowResult dataflow_definite_assignment(const TACInstruction *code, int count)
+{
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    DataflowProblem p;
+    dataflow_init_problem(&p, DATAFLOW_FORWARD, DATAFLOW_INTERSECT, count, dataflow_id_count(&ids));
+
+    for (int i = 0; i < count; i++)
+    {
+        int def = dataflow_def_id(&ids, &code[i]);
+        if (def >= 0)
+            bitset_set(&p.gen[i], def);
+    }
+
+    dataflow_solve(&p);
+    return take_result(&p, ids);
+}
+
+/* Forward may-problem over definition sites: bit i stands for the definition
+   made by instruction i; an instruction kills every other definition of the
+   operand it writes. */
+DataflowResult dataflow_reaching_definitions(const TACInstruction *code, int count)
+{
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    int nids = dataflow_id_count(&ids);
+    DataflowProblem p;
+    dataflow_init_problem(&p, DATAFLOW_FORWARD, DATAFLOW_UNION, count, count);
+
+    // all definition sites of each operand, so kill sets are built in one pass
+    BitSet *defs_of = bitset_array(nids, count);
+    for (int i = 0; i < count; i++)
+    {
+        int def = dataflow_def_id(&ids, &code[i]);
+        if (def >= 0)
+            bitset_set(&defs_of[def], i);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        int def = dataflow_def_id(&ids, &code[i]);
+        if (def < 0)
+            continue;
+        bitset_set(&p.gen[i], i);
+        bitset_copy(&p.kill[i], &defs_of[def]);
+        bitset_reset(&p.kill[i], i);
+    }
+
+    free_bitset_array(defs_of, nids);
+    dataflow_solve(&p);
+    return take_result(&p, ids);
+}
+
+void dataflow_free_result(DataflowResult *r)
+{
+    free_bitset_array(r->in, r->count);
+    free_bitset_array(r->out, r->count);
+    r->in = r->out = NULL;
+    r->count = 0;
+}
@@ -0,0 +1,31 @@
+// dce.c
+#include "headers/dce.h"
+
+int dce_optimize(TACInstruction *code, int *count)
+{
+    int removed = 0;
+
+    // a removed instruction can leave the producer of its operands dead too
+    for (;;)
+    {
+        int n = *count;
+        DataflowResult live = dataflow_liveness(code, n, 1);
+
+        int j = 0;
+        for (int i = 0; i < n; i++)
+        {
+            int def = dataflow_def_id(&live.ids, &code[i]);
+            if (def >= 0 && !bitset_test(&live.out[i], def))
+                continue;
+            code[j++] = code[i];
+        }
+        dataflow_free_result(&live);
+
+        removed += n - j;
+        *count = j;
+        if (j == n)
+            break;
+    }
+
+    return removed;
+}
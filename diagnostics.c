@@ -0,0 +1,333 @@
+// diagnostics.c
+#include <stdarg.h>
+#include "headers/diagnostics.h"
+
+#define DIAG_MAX_ARGS 3
+
+typedef enum
+{
+    DIAG_ERROR,
+    DIAG_WARNING
+} DiagSeverity;
+
+typedef struct
+{
+    const char *id;     // stable code printed in JSON
+    DiagSeverity severity;
+    const char *prefix; // text shown before the message
+    const char *format; // only %s conversions, one per argument
+    int nargs;
+} DiagInfo;
+
+static const DiagInfo diag_info[DIAG_CODE_COUNT] = {
+    [DIAG_LEX_TOO_MANY_TOKENS] = {"L001", DIAG_ERROR, "Lexer Error", "Reached max tokens", 0},
+    [DIAG_LEX_UNCLOSED_COMMENT] = {"L002", DIAG_ERROR, "Lexer Error", "Unclosed multi-line comment", 0},
+    [DIAG_LEX_BAD_CHAR_LITERAL] = {"L003", DIAG_ERROR, "Lexer Error", "Unterminated or invalid character literal", 0},
+    [DIAG_LEX_UNKNOWN_SYMBOL] = {"L004", DIAG_ERROR, "Lexer Error", "Unknown symbol (ASCII %s) '%s'", 2},
+    [DIAG_SYNTAX] = {"P001", DIAG_ERROR, "Syntax Error", "%s", 1},
+    [DIAG_SYM_REDECLARATION] = {"S001", DIAG_ERROR, "Semantic Error", "Redeclaration of variable '%s' (previously declared as '%s')", 2},
+    [DIAG_SYM_OVERFLOW] = {"S002", DIAG_ERROR, "Symbol Table Overflow", "Too many symbols", 0},
+    [DIAG_SYM_UNDECLARED_ASSIGN] = {"S003", DIAG_ERROR, "Semantic Error", "Undeclared variable '%s' used in assignment", 1},
+    [DIAG_SYM_TYPE_MISMATCH] = {"S004", DIAG_WARNING, "Semantic Warning", "Type mismatch assigning to '%s' (%s <- %s)", 3},
+    [DIAG_SEM_UNDECLARED] = {"E001", DIAG_ERROR, "Semantic Error", "Undeclared identifier '%s'", 1},
+    [DIAG_SEM_ASSIGN_UNDECLARED] = {"E002", DIAG_ERROR, "Semantic Error", "Assignment to undeclared variable '%s'", 1},
+    [DIAG_SEM_INVALID_LHS] = {"E003", DIAG_ERROR, "Semantic Error", "Invalid assignment LHS", 0},
+    [DIAG_SEM_INVALID_IDENTIFIER] = {"E004", DIAG_ERROR, "Semantic Error", "Invalid identifier on LHS", 0},
+    [DIAG_SEM_DIVISION_BY_ZERO] = {"E005", DIAG_ERROR, "Semantic Error", "Division by zero detected at compile time", 0},
+    [DIAG_SEM_UNINITIALIZED] = {"W001", DIAG_WARNING, "Semantic Warning", "Use of uninitialized variable '%s'", 1},
+    [DIAG_SEM_UNUSED] = {"W002", DIAG_WARNING, "Semantic Warning", "Variable '%s' declared but never initialized or used", 1},
+};
+
+// One record per distinct (code, line, arguments). Strings live in a shared pool
+// and are referenced by offset; -1 means absent.
+typedef struct
+{
+    unsigned short code;
+    int line;
+    int count;
+    int near;
+    int args[DIAG_MAX_ARGS];
+    unsigned hash;
+} DiagRecord;
+
+static DiagRecord *records = NULL;
+static int record_count = 0;
+static int record_capacity = 0;
+
+static char *pool = NULL;
+static size_t pool_size = 0;
+static size_t pool_capacity = 0;
+
+// open-addressing table of record index + 1 (0 = empty slot)
+static int *buckets = NULL;
+static int bucket_count = 0;
+
+static int errors = 0;
+static int warnings = 0;
+static int max_errors = 0;
+static DiagFormat format = DIAG_FORMAT_TEXT;
+
+// === Storage helpers ===
+static void *grow(void *buf, size_t elem, int *capacity, int needed)
+{
+    if (needed <= *capacity)
+        return buf;
+
+    int newcap = *capacity == 0 ? 64 : *capacity;
+    while (newcap < needed)
+        newcap *= 2;
+
+    void *tmp = realloc(buf, elem * newcap);
+    if (!tmp)
+    {
+        fprintf(stderr, "Memory allocation failed in diagnostics\n");
+        exit(1);
+    }
+    *capacity = newcap;
+    return tmp;
+}
+
+static int pool_add(const char *s)
+{
+    if (!s)
+        return -1;
+
+    size_t len = strlen(s) + 1;
+    if (pool_size + len > pool_capacity)
+    {
+        size_t newcap = pool_capacity == 0 ? 1024 : pool_capacity;
+        while (newcap < pool_size + len)
+            newcap *= 2;
+        char *tmp = realloc(pool, newcap);
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed in diagnostics\n");
+            exit(1);
+        }
+        pool = tmp;
+        pool_capacity = newcap;
+    }
+
+    memcpy(pool + pool_size, s, len);
+    int offset = (int)pool_size;
+    pool_size += len;
+    return offset;
+}
+
+static const char *pool_str(int offset)
+{
+    return offset < 0 ? NULL : pool + offset;
+}
+
+// FNV-1a over the code, line and argument strings
+static unsigned hash_key(DiagCode code, int line, const char **args, int nargs)
+{
+    unsigned h = (2166136261u ^ (unsigned)code) * 16777619u;
+    h = (h ^ (unsigned)line) * 16777619u;
+    for (int i = 0; i < nargs; i++)
+    {
+        for (const char *p = args[i] ? args[i] : ""; *p; p++)
+            h = (h ^ (unsigned char)*p) * 16777619u;
+        h = (h ^ 0xFF) * 16777619u; // argument separator
+    }
+    return h;
+}
+
+static int same_key(const DiagRecord *r, DiagCode code, int line, const char **args, int nargs)
+{
+    if (r->code != code || r->line != line)
+        return 0;
+    for (int i = 0; i < nargs; i++)
+    {
+        const char *stored = pool_str(r->args[i]);
+        if (strcmp(stored ? stored : "", args[i] ? args[i] : "") != 0)
+            return 0;
+    }
+    return 1;
+}
+
+static void rehash(void)
+{
+    int newcount = bucket_count == 0 ? 128 : bucket_count * 2;
+    int *newbuckets = calloc(newcount, sizeof(int));
+    if (!newbuckets)
+    {
+        fprintf(stderr, "Memory allocation failed in diagnostics\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < record_count; i++)
+    {
+        int slot = records[i].hash & (newcount - 1);
+        while (newbuckets[slot])
+            slot = (slot + 1) & (newcount - 1);
+        newbuckets[slot] = i + 1;
+    }
+
+    free(buckets);
+    buckets = newbuckets;
+    bucket_count = newcount;
+}
+
+// === Public API ===
+void diag_report(DiagCode code, int line, const char *near, ...)
+{
+    const DiagInfo *info = &diag_info[code];
+    const char *args[DIAG_MAX_ARGS] = {NULL, NULL, NULL};
+
+    va_list ap;
+    va_start(ap, near);
+    for (int i = 0; i < info->nargs; i++)
+        args[i] = va_arg(ap, const char *);
+    va_end(ap);
+
+    if (info->severity == DIAG_ERROR)
+        errors++;
+    else
+        warnings++;
+
+    // keep the load factor under one half
+    if ((record_count + 1) * 2 > bucket_count)
+        rehash();
+
+    unsigned h = hash_key(code, line, args, info->nargs);
+    int slot = h & (bucket_count - 1);
+    while (buckets[slot])
+    {
+        DiagRecord *r = &records[buckets[slot] - 1];
+        if (r->hash == h && same_key(r, code, line, args, info->nargs))
+        {
+            r->count++;
+            return;
+        }
+        slot = (slot + 1) & (bucket_count - 1);
+    }
+
+    records = grow(records, sizeof(DiagRecord), &record_capacity, record_count + 1);
+    DiagRecord *r = &records[record_count];
+    r->code = (unsigned short)code;
+    r->line = line;
+    r->count = 1;
+    r->near = pool_add(near);
+    for (int i = 0; i < DIAG_MAX_ARGS; i++)
+        r->args[i] = i < info->nargs ? pool_add(args[i] ? args[i] : "") : -1;
+    r->hash = h;
+    buckets[slot] = ++record_count;
+}
+
+void diag_set_format(DiagFormat f) { format = f; }
+
+void diag_set_max_errors(int n) { max_errors = n; }
+
+int diag_should_abort(void) { return max_errors > 0 && errors >= max_errors; }
+
+int diag_error_count(void) { return errors; }
+
+int diag_warning_count(void) { return warnings; }
+
+// === Output ===
+typedef struct
+{
+    char *data;
+    int size;
+    int capacity;
+} OutBuffer;
+
+static void out_printf(OutBuffer *out, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+
+    out->data = grow(out->data, 1, &out->capacity, out->size + len + 1);
+
+    va_start(ap, fmt);
+    vsnprintf(out->data + out->size, len + 1, fmt, ap);
+    va_end(ap);
+    out->size += len;
+}
+
+static void out_json_string(OutBuffer *out, const char *s)
+{
+    out_printf(out, "\"");
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            out_printf(out, "\\%c", c);
+        else if (c < 0x20)
+            out_printf(out, "\\u%04x", c);
+        else
+            out_printf(out, "%c", c);
+    }
+    out_printf(out, "\"");
+}
+
+static void format_message(const DiagRecord *r, char *buf, size_t size)
+{
+    const DiagInfo *info = &diag_info[r->code];
+    const char *a[DIAG_MAX_ARGS];
+    for (int i = 0; i < DIAG_MAX_ARGS; i++)
+        a[i] = r->args[i] >= 0 ? pool_str(r->args[i]) : "";
+    snprintf(buf, size, info->format, a[0], a[1], a[2]);
+}
+
+void diag_flush(void)
+{
+    OutBuffer out = {NULL, 0, 0};
+    char message[512];
+
+    if (format == DIAG_FORMAT_JSON)
+        out_printf(&out, "{\"diagnostics\":[");
+
+    for (int i = 0; i < record_count; i++)
+    {
+        const DiagRecord *r = &records[i];
+        const DiagInfo *info = &diag_info[r->code];
+        const char *near = pool_str(r->near);
+        format_message(r, message, sizeof(message));
+
+        if (format == DIAG_FORMAT_JSON)
+        {
+            out_printf(&out, "%s{\"code\":\"%s\",\"severity\":\"%s\",\"message\":", i ? "," : "", info->id,
+                       info->severity == DIAG_ERROR ? "error" : "warning");
+            out_json_string(&out, message);
+            out_printf(&out, ",\"line\":%d,\"near\":", r->line);
+            if (near)
+                out_json_string(&out, near);
+            else
+                out_printf(&out, "null");
+            out_printf(&out, ",\"count\":%d}", r->count);
+        }
+        else
+        {
+            out_printf(&out, "%s: %s", info->prefix, message);
+            if (r->line > 0)
+                out_printf(&out, " (line %d", r->line);
+            if (near)
+                out_printf(&out, r->line > 0 ? ", near '%s')" : " (near '%s')", near);
+            else if (r->line > 0)
+                out_printf(&out, ")");
+            if (r->count > 1)
+                out_printf(&out, " [repeated %d times]", r->count);
+            out_printf(&out, "\n");
+        }
+    }
+
+    if (format == DIAG_FORMAT_JSON)
+        out_printf(&out, "],\"errors\":%d,\"warnings\":%d}\n", errors, warnings);
+
+    if (out.size > 0)
+    {
+        fflush(stdout); // keep phase output that came before in front of the report
+        fwrite(out.data, 1, out.size, stderr);
+        fflush(stderr);
+    }
+    free(out.data);
+
+    record_count = 0;
+    pool_size = 0;
+    if (buckets)
+        memset(buckets, 0, sizeof(int) * bucket_count);
+}
@@ -0,0 +1,168 @@
+// gvn.c
+#include "headers/gvn.h"
+
+// an operand inside an expression key: a value number or a constant
+typedef struct
+{
+    int is_const;
+    long long value;
+} VNOperand;
+
+typedef struct
+{
+    unsigned int op;
+    VNOperand a;
+    VNOperand b;
+    int vn; // value number of the expression
+} VNEntry;
+
+static void *gvn_alloc(size_t size)
+{
+    void *p = calloc(1, size > 0 ? size : 1);
+    if (!p)
+    {
+        fprintf(stderr, "Memory allocation failed in gvn\n");
+        exit(1);
+    }
+    return p;
+}
+
+static VNOperand vn_operand(TACOperand operand, int value, const int *vn)
+{
+    VNOperand o;
+    o.is_const = value < 0;
+    o.value = o.is_const ? tac_const_value(operand) : vn[value];
+    return o;
+}
+
+static int vn_operand_less(VNOperand x, VNOperand y)
+{
+    if (x.is_const != y.is_const)
+        return x.is_const < y.is_const;
+    return x.value < y.value;
+}
+
+static int same_key(const VNEntry *e, unsigned int op, VNOperand a, VNOperand b)
+{
+    return e->op == op && e->a.is_const == a.is_const && e->a.value == a.value &&
+           e->b.is_const == b.is_const && e->b.value == b.value;
+}
+
+static unsigned hash_key(unsigned int op, VNOperand a, VNOperand b)
+{
+    unsigned long long h = op * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (unsigned long long)a.value ^ ((unsigned long long)a.is_const << 63)) * 0xFF51AFD7ED558CCDULL;
+    h = (h ^ (unsigned long long)b.value ^ ((unsigned long long)b.is_const << 62)) * 0xC4CEB9FE1A85EC53ULL;
+    return (unsigned)(h >> 32);
+}
+
+int gvn_optimize(TACInstruction *code, int *count)
+{
+    int n = *count;
+    if (n == 0)
+        return 0;
+
+    SSAForm ssa = ssa_build(code, n);
+    int nids = dataflow_id_count(&ssa.ids);
+
+    int *vn = gvn_alloc(sizeof(int) * ssa.value_count);
+    int *leader = gvn_alloc(sizeof(int) * ssa.value_count); // value number -> SSA value holding it
+    int *current = gvn_alloc(sizeof(int) * (nids > 0 ? nids : 1));
+
+    // entry values: each its own number
+    for (int v = 0; v < ssa.value_count; v++)
+    {
+        vn[v] = v;
+        leader[v] = v;
+        if (ssa.values[v].def == SSA_ENTRY_DEF)
+            current[ssa.values[v].id] = v;
+    }
+
+    int bucket_count = 16;
+    while (bucket_count < 2 * n)
+        bucket_count *= 2;
+    VNEntry *entries = gvn_alloc(sizeof(VNEntry) * n);
+    int *buckets = gvn_alloc(sizeof(int) * bucket_count); // entry index + 1, 0 = empty
+    int entry_count = 0;
+
+    int replaced = 0;
+    int j = 0;
+    for (int i = 0; i < n; i++)
+    {
+        TACInstruction ins = code[i];
+        int def = ssa.def_value[i];
+
+        if (def < 0)
+        {
+            code[j++] = ins;
+            continue;
+        }
+
+        int number = def;
+        if (ins.op == TAC_COPY)
+        {
+            // a copy names an existing value; a constant is a value of its own
+            if (ssa.use_value[i][0] >= 0)
+                number = vn[ssa.use_value[i][0]];
+        }
+        else
+        {
+            VNOperand a = vn_operand(ins.arg1, ssa.use_value[i][0], vn);
+            VNOperand b = vn_operand(ins.arg2, ssa.use_value[i][1], vn);
+            if ((ins.op == TAC_ADD || ins.op == TAC_MUL || ins.op == TAC_MULHI) && vn_operand_less(b, a))
+            {
+                VNOperand t = a;
+                a = b;
+                b = t;
+            }
+
+            unsigned slot = hash_key(ins.op, a, b) & (bucket_count - 1);
+            while (buckets[slot] && !same_key(&entries[buckets[slot] - 1], ins.op, a, b))
+                slot = (slot + 1) & (bucket_count - 1);
+
+            if (buckets[slot])
+                number = entries[buckets[slot] - 1].vn;
+            else
+            {
+                VNEntry *e = &entries[entry_count];
+                e->op = ins.op;
+                e->a = a;
+                e->b = b;
+                e->vn = def;
+                buckets[slot] = ++entry_count;
+            }
+
+            // reuse the value if whoever computed it still holds it
+            int held = leader[number];
+            if (number != def && current[ssa.values[held].id] == held)
+            {
+                replaced++;
+                ins.op = TAC_COPY;
+                ins.arg1 = dataflow_id_operand(&ssa.ids, ssa.values[held].id);
+                ins.arg2 = TAC_NO_OPERAND;
+            }
+        }
+
+        vn[def] = number;
+        current[ssa.values[def].id] = def;
+
+        // keep a live holder for each number
+        int held = leader[number];
+        if (current[ssa.values[held].id] != held)
+            leader[number] = def;
+
+        // x = x needs no instruction
+        if (ins.op == TAC_COPY && ins.arg1 == ins.result)
+            continue;
+        code[j++] = ins;
+    }
+    *count = j;
+
+    free(entries);
+    free(buckets);
+    free(vn);
+    free(leader);
+    free(current);
+    ssa_free(&ssa);
+    return replaced;
+}
@@ -0,0 +1,21 @@
+#ifndef COPY_PROPAGATION_H
+#define COPY_PROPAGATION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "ssa.h"
+
+/* Replaces reads of a copy with reads of its source, following chains
+   such as t1 = a; t2 = t1, as long as the source still holds the copied
+   value. The copies themselves are left for dead code elimination.
+   Returns the number of operands rewritten. */
+int copy_propagate(TACInstruction *code, int *count);
+
+/* Removes x = t where temporary t is read only there: the instruction
+   that computed t writes x directly instead, provided nothing between
+   the two touches x. Returns the number of copies removed. */
+int coalesce_copies(TACInstruction *code, int *count);
+
+#endif // COPY_PROPAGATION_H
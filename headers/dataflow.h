@@ -0,0 +1,107 @@
+#ifndef DATAFLOW_H
+#define DATAFLOW_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "symbol_table.h"
+
+// === BIT SETS ===
+// Dense bit-vector; set operations work a whole 64-bit word at a time.
+typedef unsigned long long BitWord;
+
+#define BITS_PER_WORD 64
+
+typedef struct
+{
+    int nbits;
+    int nwords;
+    BitWord *words;
+} BitSet;
+
+BitSet bitset_create(int nbits);
+void bitset_free(BitSet *set);
+void bitset_clear_all(BitSet *set);
+void bitset_fill(BitSet *set);
+void bitset_set(BitSet *set, int bit);
+void bitset_reset(BitSet *set, int bit);
+int bitset_test(const BitSet *set, int bit);
+void bitset_copy(BitSet *dst, const BitSet *src);
+int bitset_union_into(BitSet *dst, const BitSet *src);
+int bitset_intersect_into(BitSet *dst, const BitSet *src);
+void bitset_subtract(BitSet *dst, const BitSet *src);
+int bitset_equals(const BitSet *a, const BitSet *b);
+int bitset_count(const BitSet *set);
+
+// === OPERAND IDS ===
+// Variables take ids [0, var_count) in symbol table order,
+// temporaries take [var_count, var_count + temp_count).
+typedef struct
+{
+    int var_count;
+    int temp_count;
+} DataflowIdSpace;
+
+DataflowIdSpace dataflow_id_space(const TACInstruction *code, int count);
+int dataflow_id_count(const DataflowIdSpace *ids);
+int dataflow_operand_id(const DataflowIdSpace *ids, TACOperand operand);
+TACOperand dataflow_id_operand(const DataflowIdSpace *ids, int id);
+int dataflow_def_id(const DataflowIdSpace *ids, const TACInstruction *ins);
+int dataflow_use_ids(const DataflowIdSpace *ids, const TACInstruction *ins, int uses[2]);
+
+// === GENERIC SOLVER ===
+typedef enum
+{
+    DATAFLOW_FORWARD,
+    DATAFLOW_BACKWARD
+} DataflowDirection;
+
+typedef enum
+{
+    DATAFLOW_UNION,    // may-problems (liveness, reaching definitions)
+    DATAFLOW_INTERSECT // must-problems (definite assignment)
+} DataflowMeet;
+
+/* One node per TAC instruction. Edges are given in CSR form
+   (succ_start[n]..succ_start[n + 1] index into succs); when they are NULL
+   the nodes form a straight line, which is all TAC can express today. */
+typedef struct
+{
+    DataflowDirection direction;
+    DataflowMeet meet;
+    int node_count;
+    int nbits;
+
+    const int *succ_start;
+    const int *succs;
+    const int *pred_start;
+    const int *preds;
+
+    BitSet *gen;
+    BitSet *kill;
+    BitSet boundary; // facts at program entry (forward) or exit (backward)
+
+    BitSet *in; // filled by dataflow_solve
+    BitSet *out;
+} DataflowProblem;
+
+void dataflow_init_problem(DataflowProblem *p, DataflowDirection dir, DataflowMeet meet, int node_count, int nbits);
+void dataflow_solve(DataflowProblem *p);
+void dataflow_free_problem(DataflowProblem *p);
+
+// === ANALYSES OVER TAC ===
+typedef struct
+{
+    int count;
+    DataflowIdSpace ids;
+    BitSet *in;
+    BitSet *out;
+} DataflowResult;
+
+DataflowResult dataflow_liveness(const TACInstruction *code, int count, int variables_live_at_exit);
+DataflowResult dataflow_definite_assignment(const TACInstruction *code, int count);
+DataflowResult dataflow_reaching_definitions(const TACInstruction *code, int count);
+void dataflow_free_result(DataflowResult *r);
+
+#endif // DATAFLOW_H
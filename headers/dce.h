@@ -0,0 +1,16 @@
+#ifndef DCE_H
+#define DCE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "dataflow.h"
+
+/* Removes instructions whose result is never read: temporaries nobody uses
+   and stores overwritten before any read. Every variable is live at exit,
+   since its final value is the program's output. Returns the number of
+   instructions removed. */
+int dce_optimize(TACInstruction *code, int *count);
+
+#endif // DCE_H
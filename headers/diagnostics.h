@@ -0,0 +1,60 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// === DIAGNOSTIC CODES ===
+typedef enum
+{
+    // lexer
+    DIAG_LEX_TOO_MANY_TOKENS,
+    DIAG_LEX_UNCLOSED_COMMENT,
+    DIAG_LEX_BAD_CHAR_LITERAL,
+    DIAG_LEX_UNKNOWN_SYMBOL,
+
+    // parser
+    DIAG_SYNTAX,
+
+    // symbol table
+    DIAG_SYM_REDECLARATION,
+    DIAG_SYM_OVERFLOW,
+    DIAG_SYM_UNDECLARED_ASSIGN,
+    DIAG_SYM_TYPE_MISMATCH,
+
+    // semantic analysis
+    DIAG_SEM_UNDECLARED,
+    DIAG_SEM_ASSIGN_UNDECLARED,
+    DIAG_SEM_INVALID_LHS,
+    DIAG_SEM_INVALID_IDENTIFIER,
+    DIAG_SEM_DIVISION_BY_ZERO,
+    DIAG_SEM_UNINITIALIZED,
+    DIAG_SEM_UNUSED,
+
+    DIAG_CODE_COUNT
+} DiagCode;
+
+typedef enum
+{
+    DIAG_FORMAT_TEXT,
+    DIAG_FORMAT_JSON
+} DiagFormat;
+
+/* Records a diagnostic; nothing is printed until diag_flush().
+   line is the source line (0 if unknown), near the lexeme it was found at
+   (may be NULL), and the remaining arguments are the strings the code's
+   message expects. A repeat of the same code, line and arguments only
+   bumps the first record's count. */
+void diag_report(DiagCode code, int line, const char *near, ...);
+
+void diag_set_format(DiagFormat format);
+void diag_set_max_errors(int max_errors); // 0 = no cap
+int diag_should_abort(void);
+int diag_error_count(void);
+int diag_warning_count(void);
+
+// writes every recorded diagnostic to stderr in one write, then clears them
+void diag_flush(void);
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,17 @@
+#ifndef GVN_H
+#define GVN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "ssa.h"
+
+/* Hash-based value numbering over the SSA form. An instruction that
+   recomputes a value some variable or temporary still holds becomes a copy
+   of it; + and * match with their operands in either order. Redefining a
+   variable gives it a new SSA value, which is what invalidates older
+   expressions that read it. Returns the number of instructions replaced. */
+int gvn_optimize(TACInstruction *code, int *count);
+
+#endif // GVN_H
@@ -8,14 +8,79 @@
 #include "syntax_analyzer.h"
 #include "symbol_table.h"
 
+// === TAC OPCODES ===
+typedef enum
+{
+    TAC_COPY, // result = arg1
+    TAC_ADD,
+    TAC_SUB,
+    TAC_MUL,
+    TAC_DIV,
+    TAC_SHL,  // result = arg1 << arg2; the shift amount is always a constant
+    TAC_SAR,  // arithmetic shift right
+    TAC_SHR,  // logical shift right
+    TAC_MULHI // high 64 bits of the signed 128-bit product
+} TACOpcode;
+
+#define tac_is_shift(op) ((op) == TAC_SHL || (op) == TAC_SAR || (op) == TAC_SHR)
+
+// === TAC OPERANDS ===
+/* An operand is one 32-bit word: the kind in the top 3 bits, a 29-bit
+   payload below it. Variables carry their symbol table index, temporaries
+   their number, and constants their value when it fits in 29 signed bits;
+   wider constants carry an index into a pool of 64-bit values, interned so
+   that equal constants always give equal operands. */
+typedef unsigned int TACOperand;
+
+typedef enum
+{
+    TAC_NONE,       // unused slot
+    TAC_VAR,        // payload: symbol table index
+    TAC_TEMP,       // payload: temporary number
+    TAC_CONST,      // payload: signed value
+    TAC_WIDE_CONST  // payload: index into the constant pool
+} TACOperandKind;
+
+#define TAC_KIND_SHIFT 29
+#define TAC_PAYLOAD_MASK ((1u << TAC_KIND_SHIFT) - 1)
+#define TAC_INLINE_MIN (-(1 << (TAC_KIND_SHIFT - 1)))
+#define TAC_INLINE_MAX ((1 << (TAC_KIND_SHIFT - 1)) - 1)
+
+#define TAC_NO_OPERAND ((TACOperand)0)
+
+#define tac_kind(o) ((TACOperandKind)((o) >> TAC_KIND_SHIFT))
+#define tac_index(o) ((int)((o) & TAC_PAYLOAD_MASK))
+#define tac_is_var(o) (tac_kind(o) == TAC_VAR)
+#define tac_is_temp(o) (tac_kind(o) == TAC_TEMP)
+#define tac_is_const(o) (tac_kind(o) == TAC_CONST || tac_kind(o) == TAC_WIDE_CONST)
+
+#define tac_var(index) ((TACOperand)(((unsigned)TAC_VAR << TAC_KIND_SHIFT) | ((unsigned)(index) & TAC_PAYLOAD_MASK)))
+#define tac_temp(n) ((TACOperand)(((unsigned)TAC_TEMP << TAC_KIND_SHIFT) | ((unsigned)(n) & TAC_PAYLOAD_MASK)))
+
+TACOperand tac_const(long long value);
+long long tac_const_value(TACOperand o);
+const long long *tac_constant_pool(int *count); // values behind TAC_WIDE_CONST, by index
+
+// === TAC INSTRUCTIONS ===
 typedef struct
 {
-    char result[64];
-    char arg1[64];
-    char op[16];
-    char arg2[64];
+    unsigned int op; // TACOpcode
+    TACOperand result;
+    TACOperand arg1;
+    TACOperand arg2; // TAC_NO_OPERAND for TAC_COPY
 } TACInstruction;
 
+// growable instruction storage for passes that insert instructions
+typedef struct
+{
+    TACInstruction *code;
+    int count;
+    int capacity;
+    int allocations; // times the storage was allocated or moved
+} TACBuffer;
+
+void tac_buffer_reserve(TACBuffer *buffer, int needed);
+
 extern TACInstruction *optimizedCode;
 extern int optimizedCount;
 
@@ -23,6 +88,13 @@ extern int optimizedCount;
 typedef struct ASTNode ASTNode;
 
 void generate_intermediate_code(ASTNode *root);
+TACInstruction *generate_statement_code(ASTNode *root, int *count); // quiet, one statement of a stream
+void reset_wide_constants(void); // streams: statements' TAC_WIDE_CONST operands stay valid until this
+void check_unused_variables(void); // streams: warns once the last statement is compiled
 TACInstruction *getOptimizedCode(int *count);
 
+const char *tac_opcode_symbol(TACOpcode op);
+// writes a variable's name, "tempN" or the constant's digits into buf
+const char *tac_operand_text(TACOperand o, char *buf, size_t size);
+
 #endif // INTERMEDIATE_CODE_GENERATOR_H
@@ -6,6 +6,7 @@
 #include <ctype.h>
 
 #include "symbol_table.h"
+#include "diagnostics.h"
 
 #define MAX_TOKENS 4096
 #define MAX_BUFFER_LEN 256
@@ -31,6 +32,7 @@ typedef struct
 {
     TokenType type;
     char lexeme[MAX_VALUE_LENGTH];
+    int line;
 } TOKEN;
 
 // === GLOBALS ===
@@ -40,6 +42,7 @@ extern int error_found;
 
 // === FUNCTION DECLARATIONS ===
 int lexer(const char *source_code);
+int lex_source(const char *source_code, int first_line); // lexer() without the listing
 int is_datatype(const char *token);
 int is_delimiter(char c);
 int is_operator_char(char c);
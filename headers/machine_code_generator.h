@@ -8,8 +8,8 @@
 #include <ctype.h>
 #include "target_code_generator.h"
 
-#define R_TYPE_COUNT 5
-#define I_TYPE_COUNT 3
+#define R_TYPE_COUNT 13
+#define I_TYPE_COUNT 5
 
 typedef struct
 {
@@ -19,4 +19,11 @@ typedef struct
 // Function prototype
 void generate_machine_code(void);
 
+/* Streaming: the .data layout is fixed one label at a time, in the order
+   the labels will be written, and each statement's lines in
+   assembly_code are encoded to out as they arrive. The layout must be
+   complete before any thread encodes a statement that uses it. */
+void add_data_symbol(const char *label);
+void encode_statement_code(FILE *out);
+
 #endif // MACHINE_CODE_GENERERATOR_H
@@ -0,0 +1,23 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_JOBS 64
+
+/* Worker threads for the back end (--jobs=N). Lowering and encoding keep
+   their registers and assembly lines per thread, so separate ranges of
+   code can be turned into assembly at the same time; callers give each
+   slot its own output and put the pieces together in slot order, which
+   keeps the result identical to a run with one job. */
+void set_job_count(int jobs); // clamped to 1 .. MAX_JOBS; 1 (the default) keeps everything on the main thread
+int job_count(void);
+
+typedef void (*ParallelTask)(int slot, void *arg);
+
+// runs task for slots 0 .. slots - 1, each on its own thread, and waits for all of them
+void parallel_run(int slots, ParallelTask task, void *arg);
+
+#endif // PARALLEL_H
@@ -0,0 +1,20 @@
+#ifndef PARTIAL_EVALUATOR_H
+#define PARTIAL_EVALUATOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "symbol_table.h"
+
+/* A BaiScript program reads no input and never branches, so running its
+   TAC at compile time gives the final value of every variable. values
+   gets one entry per symbol, starting from the zeroes in .data.
+
+   Returns -1 when every instruction was evaluated. Otherwise returns the
+   index of the first instruction whose result is up to the hardware (a
+   division by zero or the overflowing division); its code then has to
+   run as usual. */
+int evaluate_program(const TACInstruction *code, int count, long long *values);
+
+#endif // PARTIAL_EVALUATOR_H
@@ -0,0 +1,37 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+
+/* Every pass rewrites the buffer in place and returns how much it changed
+   (instructions folded, operands rewritten, ...; 0 means nothing). */
+typedef int (*PassFunction)(TACBuffer *ir);
+
+typedef struct
+{
+    const char *name; // as written in --passes=
+    PassFunction run;
+} PassInfo;
+
+#define PASS_MAX_PIPELINE 32
+#define PASS_MAX_ITERATIONS 8 // rounds of an iterated pipeline
+
+/* -O0: no passes. -O1 (default): each pass once. -O2: adds
+   reassociation and repeats the pipeline until a round changes nothing.
+   -Os: repeats the passes that only ever shrink the code. Returns 0 on
+   success, 1 for an unknown level. */
+int set_optimization_level(const char *level);
+
+/* Runs exactly the comma-separated passes, in order, once each. Returns
+   0 on success, 1 (after printing the known names) for an unknown pass. */
+int set_pass_list(const char *list);
+
+// runs the selected pipeline over ir, adding to the per-pass totals
+void run_passes(TACBuffer *ir);
+void reset_pass_stats(void);
+void print_pass_report(void);
+
+#endif // PASS_MANAGER_H
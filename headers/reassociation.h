@@ -0,0 +1,27 @@
+#ifndef REASSOCIATION_H
+#define REASSOCIATION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "dataflow.h"
+
+typedef struct
+{
+    int trees;         // expression trees rebuilt
+    int height_before; // longest dependency chain in the code, before
+    int height_after;  // and after
+} ReassociationStats;
+
+/* Flattens chains of + and - (and chains of *) joined through single-use
+   temporaries, folds their constants together and rebuilds them as
+   balanced trees, so independent operations no longer wait on each other.
+   Integer arithmetic wraps, so any grouping gives the same result. The
+   rebuilt tree reads its operands where the root was; a tree with an
+   operand written between a read and the root (x++ inside the
+   expression) is left alone, since moving the read would change what it
+   sees. */
+ReassociationStats reassociate(TACBuffer *ir);
+
+#endif // REASSOCIATION_H
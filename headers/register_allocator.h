@@ -0,0 +1,56 @@
+#ifndef REGISTER_ALLOCATOR_H
+#define REGISTER_ALLOCATOR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "dataflow.h"
+
+/* Linear-scan register allocation over straight-line TAC (Poletto and
+   Sarkar). Every temporary and every variable the code touches gets one
+   live interval, from the first instruction that reads or writes it to
+   the last. A variable that keeps a register is loaded at its first read
+   (unless it is written first) and stored back once, when its interval
+   ends, if the code wrote it; in between it never touches memory.
+   Registers are handed out from a bitmask of free ones.
+
+   An interval that starts with a copy from an interval ending there takes
+   over its register, and a temporary only computed to be copied into a
+   resident variable is computed in that variable's register, so neither
+   copy needs a move. When more intervals
+   overlap than there are registers, the one that ends last gives its
+   register up. Variables can always go back to
+   memory; a temporary that cannot get a register is left for the code
+   generator to place. */
+#define REGALLOC_REGISTERS 16 // r1 .. r16; the rest stay free for scratch values
+
+typedef struct
+{
+    DataflowIdSpace ids;
+    int *reg;    // per id: register number (0 = r1), -1 in memory or not placed
+    int *start;  // per id: first position that touches it, -1 if none does
+    int *end;    // per id: last position that touches it
+    char *dirty; // per id (variables): written, so stored when the interval ends
+    int *copied_from; // per id: a copy's source, when that copy starts the interval; else -1
+    int *copied_into; // per temporary: the variable a copy ending it goes to, if it may use its register; else -1
+} RegisterPlan;
+
+/* Plans registers for code[0 .. count). position[i] is where
+   instruction i's work is emitted (an instruction can be emitted together
+   with a later or earlier one); when hidden[i] is set, i is computed
+   inside another instruction's sequence, so only its variable reads
+   count, at position[i]. in_memory marks variables (by symbol index) that
+   must stay in memory. Any of the three may be NULL. */
+RegisterPlan regalloc_plan(const TACInstruction *code, int count, const int *position, const char *hidden,
+                           const char *in_memory);
+void regalloc_free(RegisterPlan *plan);
+
+/* Reorders each expression tree in code so that, at every node, the
+   operand that needs more registers is computed first (Sethi and
+   Ullman), which keeps the fewest temporaries live at once. Only trees
+   whose instructions run back to back are touched, so no variable is
+   read or written in a different order. */
+void regalloc_order_trees(TACInstruction *code, int count);
+
+#endif // REGISTER_ALLOCATOR_H
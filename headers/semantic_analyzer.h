@@ -9,6 +9,7 @@
 
 #include "syntax_analyzer.h"
 #include "symbol_table.h"
+#include "diagnostics.h"
 
 #define SEM_MAX_TEMPS 2048
 typedef enum
@@ -23,7 +24,8 @@ typedef struct
     int id;
     SEM_TYPE type;
     int is_constant;
-    long int_value;
+    int has_side_effects; // subtree assigns or increments a variable
+    long long int_value;
     ASTNode *node;
 } SEM_TEMP;
 
@@ -32,12 +34,14 @@ typedef struct KnownVar
     char *name;
     SEM_TEMP temp;
     int initialized;
-    int used;
     struct KnownVar *next;
 } KnownVar;
 
 /* Public API */
 int semantic_analyzer(void);
+int semantic_analyze(ASTNode *tree); // one chunk of statements at a time, quietly
+void semantic_finish(void);          // end of a streamed program
 int semantic_error_count(void);
+size_t semantic_peak_memory(void);
 
 #endif
@@ -0,0 +1,85 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "dataflow.h"
+
+// === SSA VALUES ===
+// Every definition of a variable or temporary gets its own value. Reads
+// before any definition see the id's entry value (version 0).
+#define SSA_ENTRY_DEF (-1)
+
+typedef struct
+{
+    int id;      // dataflow id of the variable or temporary
+    int version; // 0 for the entry value, then 1, 2, ... per definition
+    int def;     // instruction index, SSA_ENTRY_DEF, or -2 - phi index
+} SSAValue;
+
+// === PHI NODES ===
+// phi(args[0], ..., args[arg_count - 1]) at the top of a block, one argument
+// per predecessor. TAC has no branches yet, so construction never needs one.
+typedef struct
+{
+    int block;
+    int id;
+    int value;
+    int *args;
+    int arg_count;
+} SSAPhi;
+
+typedef struct
+{
+    int start; // first instruction
+    int end;   // one past the last instruction
+    int first_phi;
+    int phi_count;
+} SSABlock;
+
+// === SSA FORM ===
+typedef struct
+{
+    DataflowIdSpace ids;
+    int count; // instructions
+
+    SSAValue *values;
+    int value_count;
+
+    int *def_value;      // per instruction; -1 if the result is not renamed
+    int (*use_value)[2]; // per instruction, arg1 and arg2; -1 for constants
+
+    SSABlock *blocks;
+    int block_count;
+    SSAPhi *phis;
+    int phi_count;
+
+    /* def-use chains in CSR form: users of value v are
+       users[user_start[v]] .. users[user_start[v + 1] - 1]; an instruction
+       appears as its index, a phi p as -1 - p */
+    int *user_start;
+    int *users;
+} SSAForm;
+
+SSAForm ssa_build(const TACInstruction *code, int count);
+void ssa_free(SSAForm *ssa);
+
+// === SPARSE CONDITIONAL CONSTANT PROPAGATION ===
+/* Computes a op b with the machine's 64-bit wraparound. Returns 0 when
+   the result is up to the hardware (division by zero, the overflowing
+   division, out-of-range shifts) and must be left to run time. */
+int tac_fold(TACOpcode op, long long a, long long b, long long *out);
+
+/* Rewrites every instruction whose value is provably constant into a
+   constant copy, substitutes constant operands, and drops temporaries
+   that were folded away. Returns the number of instructions folded. */
+int sccp_optimize(TACInstruction *code, int *count);
+
+/* Whether variables hold the zeroes from .data when the code starts (the
+   default). Off when the code is one statement of a streamed program and
+   variables carry whatever earlier statements left in them. */
+void sccp_set_entry_values_zero(int zero);
+
+#endif // SSA_H
@@ -0,0 +1,24 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Compiles path one statement at a time: each '!'-terminated statement is
+   lexed, parsed, checked, lowered, optimized, turned into assembly and
+   encoded before the next one is read, and freed afterwards. Only the
+   symbol table, the statement being compiled and the code written so far
+   (kept in a temporary file) are held, so memory does not grow with the
+   length of the program. output_assembly.txt gets its .data section, in
+   first-use order, once the last statement is done. With --jobs above 1
+   the assembly and machine code for a few thousand statements at a time
+   are produced on worker threads, with the same output.
+
+   Every statement is optimized on its own, so values are not propagated
+   from one statement's code to the next beyond what the semantic
+   analyzer already folds. Compile errors are reported and return 0, as in
+   a normal run; 1 means path or the output could not be opened. */
+int compile_streaming(const char *path);
+
+#endif // STREAM_H
@@ -0,0 +1,22 @@
+#ifndef STRENGTH_REDUCTION_H
+#define STRENGTH_REDUCTION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "dataflow.h"
+
+// rough cycle costs used to decide whether a rewrite pays off
+#define COST_ALU 1      // daddu, dsubu, dsll, dsra, dsrl
+#define COST_MULTIPLY 6 // dmult + mflo
+#define COST_DIVIDE 40  // ddiv + mflo
+
+/* Rewrites multiplication by a constant into shifts and adds/subtracts
+   when the sequence is cheaper than dmult, and signed division by a
+   constant into a shift with a rounding fixup (powers of two) or a
+   multiply-high by a magic number. May insert instructions, so it takes
+   the whole buffer. Returns the number of instructions rewritten. */
+int strength_reduce(TACBuffer *ir);
+
+#endif // STRENGTH_REDUCTION_H
@@ -0,0 +1,86 @@
+#ifndef SUPEROPT_H
+#define SUPEROPT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Shared by the backend and the offline superoptimizer (superoptimizer.c),
+   which writes superopt_table.c. Neither side depends on the rest of the
+   compiler here.
+
+   A shape is a small expression tree written in canonical prefix form,
+   e.g. "(+ (<< a 2) a)". Operators use TAC's symbols (+ - * << >> >>>),
+   variables are named a and b, and constants are decimal. Commutative
+   operands are sorted and the variable names chosen so that equivalent
+   trees produce the same text. */
+#define SUPEROPT_MAX_INPUTS 2 // distinct variables in a shape
+#define SUPEROPT_MAX_OPS 4    // operators in a shape
+#define SUPEROPT_MAX_STEPS 8  // instructions in a replacement
+#define SUPEROPT_MAX_SHAPE 128
+
+typedef struct
+{
+    char op[4];      // TAC symbol; "" for a leaf
+    int var;         // leaf: variable number, -1 for a constant
+    long long value; // constant leaf
+    int left, right; // operator: node indices
+} SuperoptNode;
+
+typedef struct
+{
+    SuperoptNode node[2 * SUPEROPT_MAX_OPS + 1];
+    int count;
+    int root;
+    int vars; // leaves use variable numbers 0 .. vars - 1
+} SuperoptTree;
+
+typedef enum
+{
+    SO_DADDU,
+    SO_DSUBU,
+    SO_DMULT, // dmult then mflo
+    SO_DSLL,  // the *32 forms for amounts of 32 and up
+    SO_DSRA,
+    SO_DSRL,
+    SO_DADDIU
+} SuperoptOpcode;
+
+/* One instruction of a replacement. Values are numbered -1 for r0, 0 and
+   1 for the variables a and b, and 2 + k for the result of step k. */
+typedef struct
+{
+    SuperoptOpcode op;
+    signed char src1, src2; // src2 is unused by shifts and daddiu
+    short imm;              // shift amount or daddiu immediate
+} SuperoptStep;
+
+typedef struct
+{
+    const char *shape;
+    int baseline; // cost of the instruction-at-a-time lowering
+    int cost;
+    int steps;
+    int result; // the last step's value, or r0 or an input when steps is 0
+    SuperoptStep step[SUPEROPT_MAX_STEPS];
+} SuperoptEntry;
+
+// sorted by shape; written by the superoptimizer
+extern const SuperoptEntry superopt_table[];
+extern const int superopt_table_size;
+
+/* Writes t's canonical shape into key and, for each of its variables, the
+   name (0 = a, 1 = b) the shape gives it into rename. Returns 0 when the
+   tree does not fit a shape (too many variables or too long). */
+int superopt_shape(const SuperoptTree *t, char *key, size_t size, int *rename);
+
+const SuperoptEntry *superopt_lookup(const SuperoptEntry *table, int size, const char *shape);
+
+// cycles a step takes: dmult's product needs several to reach LO
+int superopt_step_cost(SuperoptOpcode op);
+
+// the semantics both sides agree on, with 64-bit wraparound
+long long superopt_apply(const char *op, long long a, long long b);
+long long superopt_run(const SuperoptStep *step, int steps, int result, const long long *inputs);
+
+#endif // SUPEROPT_H
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include "diagnostics.h"
 
 #define MAX_SYMBOLS 1024
 
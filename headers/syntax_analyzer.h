@@ -31,6 +31,7 @@ typedef struct ASTNode
 {
     NodeType type;
     char *value; // Pointer to dynamically allocated string
+    int line;    // source line of the last token read when the node was built
     struct ASTNode *left;
     struct ASTNode *right;
 } ASTNode;
@@ -45,6 +46,7 @@ void print_ast(ASTNode *node, int depth);
 // === PARSER ENTRY POINT ===
 ASTNode *parse_program();
 int syntax_analyzer();
+int parse_tokens(); // syntax_analyzer() without the AST listing
 
 // === PARSER SUBFUNCTIONS (Forward Declarations) ===
 ASTNode *parse_statement_list();
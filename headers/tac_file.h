@@ -0,0 +1,55 @@
+#ifndef TAC_FILE_H
+#define TAC_FILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "intermediate_code_generator.h"
+#include "symbol_table.h"
+
+/* Binary TAC file, all fields in the writer's byte order:
+
+     header        TACFileHeader (32 bytes)
+     instructions  instruction_count x TACInstruction (16 bytes each)
+     constants     constant_count x 64-bit value (the TAC_WIDE_CONST pool)
+     symbols       symbol_count x TACFileSymbol (64 bytes each)
+
+   Instructions come first so that, mapped at a page boundary, they are
+   already aligned and the backend can run on the mapping directly.
+   Temporaries are numbered in order of definition, each defined once
+   before it is read, so every temporary is below instruction_count. */
+#define TAC_FILE_MAGIC "BTAC"
+#define TAC_FILE_VERSION 1
+#define TAC_FILE_BYTE_ORDER 0x01020304u
+
+typedef struct
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int byte_order; // TAC_FILE_BYTE_ORDER as the writer stored it
+    unsigned int instruction_count;
+    unsigned int constant_count;
+    unsigned int symbol_count;
+    unsigned int reserved[2];
+} TACFileHeader;
+
+typedef struct
+{
+    char name[50];
+    char datatype[10];
+    int initialized;
+} TACFileSymbol;
+
+// both return 0 on success, 1 (after printing why) on failure
+int tac_write_binary(const char *path, const TACInstruction *code, int count);
+int tac_write_text(const char *path, const TACInstruction *code, int count);
+
+/* Maps a binary TAC file and returns its instructions in place; they stay
+   valid until tac_unload(). Fills the symbol table and the constant pool
+   as a side effect. Returns NULL (after printing why) if the file is
+   missing, truncated, from another version or byte order, or refers to
+   symbols or constants it does not contain. */
+TACInstruction *tac_load_binary(const char *path, int *count);
+void tac_unload(void);
+
+#endif // TAC_FILE_H
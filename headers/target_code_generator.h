@@ -11,10 +11,11 @@
 #define MAX_DATA_LENGTH 50
 #define MAX_DATA 256
 #define MAX_REGISTER_NAME_LENGTH 10
-#define MAX_REGISTERS 30
+#define MAX_REGISTERS 28 // r1 .. r28; r29 is sp, which spill slots are addressed from
 #define MAX_TAC 256
 #define MAX_ASSEMBLY_CODE 9999
 #define MAX_ASSEMBLY_LINE 128
+#define MAX_CONSTANT_POOL 256 // wide constants given a .data slot; any others are built with lui/ori/dsll
 
 // 2D array for storage of Data section
 typedef struct
@@ -26,7 +27,7 @@ typedef struct
 {
     char name[MAX_REGISTER_NAME_LENGTH];
     int used;
-    char assigned_temp[MAX_REGISTER_NAME_LENGTH];
+    TACOperand assigned_temp; // TAC_NO_OPERAND when not holding a temporary
 } Register;
 
 // Struct to hold the generated assembly output
@@ -35,10 +36,29 @@ typedef struct
     char assembly[MAX_ASSEMBLY_LINE];
 } ASSEMBLY;
 
-extern int assembly_code_count;
-extern ASSEMBLY assembly_code[MAX_ASSEMBLY_CODE];
+// per thread, so worker threads can lower code alongside each other (see parallel.h)
+extern _Thread_local int assembly_code_count;
+extern _Thread_local ASSEMBLY assembly_code[MAX_ASSEMBLY_CODE];
 
 void initialize_registers();
+void set_keep_data(int keep); // emit a .data slot even for variables the code no longer touches
+void set_superoptimizer(int on); // use superopt_table.c's sequences for the shapes it lists (default on)
+void set_msa(int on);            // pack pairs of 64-bit operations into MSA vector instructions (default off)
+void set_register_allocation(int on); // keep variables in registers across statements (default on)
+void set_memory_forwarding(int on);   // reuse values already loaded or stored instead of reloading them (default on)
 void generate_target_code();
 
+// a .data section holding values (one per symbol) and an empty .code section
+void generate_evaluated_target_code(const long long *values);
+
+/* Streaming: appends the lines for one statement's optimized code to out,
+   leaving them in this thread's assembly_code for the encoder. */
+void generate_statement_target_code(const TACInstruction *code, int count, FILE *out);
+
+/* Writes output_assembly.txt from a streamed program: a .data slot for
+   each symbol index in order (and, with --keep-data, for the other
+   symbols after them), then the code collected in code. Returns
+   0 on success, 1 (after printing why) on failure. */
+int write_streamed_assembly(const int *order, int count, FILE *code);
+
 #endif
@@ -5,13 +5,24 @@
 #include <ctype.h>
 
 #include "headers/intermediate_code_generator.h"
-
-static TACInstruction *code = NULL;
+#include "headers/dataflow.h"
+#include "headers/pass_manager.h"
+#include "headers/ssa.h"
+
+/* One contiguous IR buffer. It grows geometrically from an estimate taken
+   from the AST, and optimization rewrites it in place, so optimizedCode
+   is the same storage once generation is done. Nothing keeps a pointer
+   into it across emit() or tac_buffer_reserve(). */
+static TACBuffer ir = {NULL, 0, 0, 0};
 TACInstruction *optimizedCode = NULL;
-static int codeCount = 0;
 int optimizedCount = 0;
 static int tempCount = 0;
 
+// streaming: variables assigned by statements already compiled
+static char assignedEarlier[MAX_SYMBOLS];
+// variables some instruction defines or reads, so far
+static char referenced[MAX_SYMBOLS];
+
 // === Utility ===
 TACInstruction *getOptimizedCode(int *count)
 {
@@ -20,52 +31,199 @@ TACInstruction *getOptimizedCode(int *count)
     return optimizedCode;
 }
 
-static char *newTemp()
+// === Operands ===
+static long long *wideConstants = NULL; // pool behind TAC_WIDE_CONST operands
+static int wideConstantCount = 0;
+
+TACOperand tac_const(long long value)
+{
+    if (value >= TAC_INLINE_MIN && value <= TAC_INLINE_MAX)
+        return ((TACOperand)TAC_CONST << TAC_KIND_SHIFT) | ((unsigned)value & TAC_PAYLOAD_MASK);
+
+    // wide constants are rare; intern them so operand equality means value equality
+    int i;
+    for (i = 0; i < wideConstantCount; i++)
+        if (wideConstants[i] == value)
+            break;
+
+    if (i == wideConstantCount)
+    {
+        long long *tmp = realloc(wideConstants, sizeof(long long) * (wideConstantCount + 1));
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed in tac_const()\n");
+            exit(1);
+        }
+        wideConstants = tmp;
+        wideConstants[wideConstantCount++] = value;
+    }
+    return ((TACOperand)TAC_WIDE_CONST << TAC_KIND_SHIFT) | (unsigned)i;
+}
+
+long long tac_const_value(TACOperand o)
 {
-    char buf[32];
-    snprintf(buf, sizeof(buf), "temp%d", tempCount++);
-    return strdup(buf);
+    if (tac_kind(o) == TAC_WIDE_CONST)
+        return wideConstants[tac_index(o)];
+
+    // sign-extend the 29-bit payload
+    int shift = 32 - TAC_KIND_SHIFT;
+    return (long long)((int)(o << shift) >> shift);
 }
 
-static void emit(const char *result, const char *arg1, const char *op, const char *arg2)
+const long long *tac_constant_pool(int *count)
 {
-    TACInstruction *tmp = realloc(code, sizeof(TACInstruction) * (codeCount + 1));
+    if (count)
+        *count = wideConstantCount;
+    return wideConstants;
+}
+
+const char *tac_opcode_symbol(TACOpcode op)
+{
+    switch (op)
+    {
+    case TAC_COPY:
+        return "=";
+    case TAC_ADD:
+        return "+";
+    case TAC_SUB:
+        return "-";
+    case TAC_MUL:
+        return "*";
+    case TAC_DIV:
+        return "/";
+    case TAC_SHL:
+        return "<<";
+    case TAC_SAR:
+        return ">>";
+    case TAC_SHR:
+        return ">>>";
+    case TAC_MULHI:
+        return "*hi";
+    }
+    return "?";
+}
+
+const char *tac_operand_text(TACOperand o, char *buf, size_t size)
+{
+    switch (tac_kind(o))
+    {
+    case TAC_VAR:
+        snprintf(buf, size, "%s", symbol_table[tac_index(o)].name);
+        break;
+    case TAC_TEMP:
+        snprintf(buf, size, "temp%d", tac_index(o));
+        break;
+    case TAC_CONST:
+    case TAC_WIDE_CONST:
+        snprintf(buf, size, "%lld", tac_const_value(o));
+        break;
+    default:
+        buf[0] = '\0';
+        break;
+    }
+    return buf;
+}
+
+static TACOpcode opcodeFor(char op)
+{
+    switch (op)
+    {
+    case '+':
+        return TAC_ADD;
+    case '-':
+        return TAC_SUB;
+    case '*':
+        return TAC_MUL;
+    default:
+        return TAC_DIV;
+    }
+}
+
+// identifiers become VAR operands, integer and character literals CONST ones
+static TACOperand leafOperand(const char *lexeme)
+{
+    if (!lexeme || lexeme[0] == '\0')
+        return tac_const(0);
+
+    if (lexeme[0] == '\'')
+        return tac_const((unsigned char)lexeme[1]);
+
+    if (isdigit((unsigned char)lexeme[0]) || lexeme[0] == '-' || lexeme[0] == '+')
+        return tac_const(strtoll(lexeme, NULL, 10));
+
+    int idx = find_symbol(lexeme);
+    return idx >= 0 ? tac_var(idx) : tac_const(0);
+}
+
+static TACOperand newTemp()
+{
+    return tac_temp(tempCount++);
+}
+
+void tac_buffer_reserve(TACBuffer *buffer, int needed)
+{
+    if (needed <= buffer->capacity)
+        return;
+
+    int newcap = buffer->capacity > 0 ? buffer->capacity : 16;
+    while (newcap < needed)
+        newcap *= 2;
+
+    TACInstruction *tmp = realloc(buffer->code, sizeof(TACInstruction) * newcap);
     if (!tmp)
     {
         fprintf(stderr, "Memory allocation failed in emit()\n");
         exit(1);
     }
-    code = tmp;
+    buffer->code = tmp;
+    buffer->capacity = newcap;
+    buffer->allocations++;
+}
+
+// every operator node emits at most two instructions, every other node none
+static int estimateInstructions(ASTNode *node)
+{
+    if (!node)
+        return 0;
+    int own = (node->left || node->right) ? 2 : 0;
+    return own + estimateInstructions(node->left) + estimateInstructions(node->right);
+}
+
+static void emit(TACOpcode op, TACOperand result, TACOperand arg1, TACOperand arg2)
+{
+    tac_buffer_reserve(&ir, ir.count + 1);
 
-    snprintf(code[codeCount].result, sizeof(code[codeCount].result), "%s", result ? result : "");
-    snprintf(code[codeCount].arg1, sizeof(code[codeCount].arg1), "%s", arg1 ? arg1 : "");
-    snprintf(code[codeCount].op, sizeof(code[codeCount].op), "%s", op ? op : "");
-    snprintf(code[codeCount].arg2, sizeof(code[codeCount].arg2), "%s", arg2 ? arg2 : "");
-    codeCount++;
+    TACInstruction *ins = &ir.code[ir.count++];
+    ins->op = op;
+    ins->result = result;
+    ins->arg1 = arg1;
+    ins->arg2 = arg2;
 }
 
 // === Expression Generator ===
-static char *generateExpression(ASTNode *node)
+/* needed is 0 when the caller throws the value away (an expression used
+   as a statement): only side effects are emitted and TAC_NO_OPERAND is
+   returned. */
+static TACOperand generateExpression(ASTNode *node, int needed)
 {
     if (!node)
-        return NULL;
+        return TAC_NO_OPERAND;
 
     // Leaf node (identifier or literal)
     if (node->left == NULL && node->right == NULL)
-        return strdup(node->value ? node->value : "");
+        return needed ? leafOperand(node->value) : TAC_NO_OPERAND;
 
     // Assignment (simple or compound)
     if (node->type == NODE_ASSIGNMENT && node->left && node->right)
     {
-        char *lhs = node->left->value;
+        TACOperand lhs = leafOperand(node->left->value);
 
         // Simple assignment
         if (strcmp(node->value, "=") == 0)
         {
-            char *rhs = generateExpression(node->right);
-            emit(lhs, rhs, "=", NULL);
-            free(rhs);
-            return strdup(lhs);
+            TACOperand rhs = generateExpression(node->right, 1);
+            emit(TAC_COPY, lhs, rhs, TAC_NO_OPERAND);
+            return lhs;
         }
         // Compound assignment (+=, -=, *=, /=)
         else if (strcmp(node->value, "+=") == 0 ||
@@ -73,76 +231,66 @@ static char *generateExpression(ASTNode *node)
                  strcmp(node->value, "*=") == 0 ||
                  strcmp(node->value, "/=") == 0)
         {
-            char op[2] = {node->value[0], '\0'}; // "+=" -> '+'
-            char *rhs = generateExpression(node->right);
-            emit(lhs, lhs, op, rhs); // x = x op rhs
-            free(rhs);
-            return strdup(lhs);
+            TACOperand rhs = generateExpression(node->right, 1);
+            emit(opcodeFor(node->value[0]), lhs, lhs, rhs); // x = x op rhs
+            return lhs;
         }
     }
 
     // Postfix operations (++ / --)
     if (node->type == NODE_POSTFIX_OP && node->left)
     {
-        char *var = generateExpression(node->left); // get current value
-        char *tmp = newTemp();                      // temp for expression
+        TACOperand var = generateExpression(node->left, 1); // get current value
+        TACOpcode op = strcmp(node->value, "--") == 0 ? TAC_SUB : TAC_ADD;
 
-        if (strcmp(node->value, "++") == 0)
-        {
-            emit(tmp, var, "=", NULL); // tmp = current value
-            emit(var, var, "+", "1");  // increment after
-        }
-        else if (strcmp(node->value, "--") == 0)
+        // nobody reads the old value: just update in place
+        if (!needed)
         {
-            emit(tmp, var, "=", NULL); // tmp = current value
-            emit(var, var, "-", "1");  // decrement after
+            emit(op, var, var, tac_const(1));
+            return TAC_NO_OPERAND;
         }
 
-        free(var);
-        return tmp; // use original value in expression
+        TACOperand tmp = newTemp();               // temp for expression
+        emit(TAC_COPY, tmp, var, TAC_NO_OPERAND); // tmp = current value
+        emit(op, var, var, tac_const(1));         // update after
+        return tmp;                               // use original value in expression
     }
 
     // Unary operators (++ / -- / + / -)
     if (node->type == NODE_UNARY_OP && node->left)
     {
-        char *lhs = generateExpression(node->left);
-        if (strcmp(node->value, "++") == 0)
-        {
-            emit(lhs, lhs, "+", "1");
-            return lhs;
-        }
-        else if (strcmp(node->value, "--") == 0)
+        if (strcmp(node->value, "++") == 0 || strcmp(node->value, "--") == 0)
         {
-            emit(lhs, lhs, "-", "1");
+            TACOperand lhs = generateExpression(node->left, 1);
+            emit(node->value[0] == '+' ? TAC_ADD : TAC_SUB, lhs, lhs, tac_const(1));
             return lhs;
         }
-        else if (strcmp(node->value, "-") == 0)
+
+        TACOperand lhs = generateExpression(node->left, needed);
+        if (strcmp(node->value, "-") == 0 && needed)
         {
-            char *tmp = newTemp();
-            emit(tmp, "0", "-", lhs);
-            free(lhs);
+            TACOperand tmp = newTemp();
+            emit(TAC_SUB, tmp, tac_const(0), lhs);
             return tmp;
         }
-        else if (strcmp(node->value, "+") == 0)
-        {
-            return lhs;
-        }
+        return lhs;
     }
 
     // Binary operations (+, -, *, /)
     if (node->left && node->right)
     {
-        char *left = generateExpression(node->left);
-        char *right = generateExpression(node->right);
-        char *tmp = newTemp();
-        emit(tmp, left, node->value, right);
-        free(left);
-        free(right);
+        TACOperand left = generateExpression(node->left, needed);
+        TACOperand right = generateExpression(node->right, needed);
+        if (!needed)
+            return TAC_NO_OPERAND; // the operands' side effects are all that matter
+
+        TACOperand tmp = newTemp();
+        emit(opcodeFor(node->value[0]), tmp, left, right);
         return tmp;
     }
 
     // fallback
-    return strdup(node->value ? node->value : "");
+    return needed ? leafOperand(node->value) : TAC_NO_OPERAND;
 }
 
 // === Code Generator ===
@@ -173,26 +321,23 @@ static void generateCode(ASTNode *node)
         {
             if (cur->left)
             {
-                char *rhs = generateExpression(cur->left);
-                if (rhs)
-                {
-                    emit(cur->value, rhs, "=", NULL);
-                    free(rhs);
-                }
+                TACOperand rhs = generateExpression(cur->left, 1);
+                emit(TAC_COPY, leafOperand(cur->value), rhs, TAC_NO_OPERAND);
             }
             cur = cur->right;
         }
         break;
     }
 
+    // an expression statement: its value is discarded
     case NODE_ASSIGNMENT:
     case NODE_EXPRESSION:
+    case NODE_TERM:
+    case NODE_FACTOR:
     case NODE_POSTFIX_OP:
     case NODE_UNARY_OP:
     {
-        char *res = generateExpression(node);
-        if (res)
-            free(res);
+        generateExpression(node, 0);
         break;
     }
 
@@ -201,50 +346,70 @@ static void generateCode(ASTNode *node)
     }
 }
 
-// === Optimization: remove redundant temporaries ===
-static void removeRedundantTemporaries()
+// === Check: reads of variables that are not definitely assigned ===
+static void checkUninitializedUses()
 {
-    if (codeCount == 0)
-        return;
-
-    optimizedCode = malloc(sizeof(TACInstruction) * codeCount);
-    memcpy(optimizedCode, code, sizeof(TACInstruction) * codeCount);
-    optimizedCount = codeCount;
+    DataflowResult assigned = dataflow_definite_assignment(ir.code, ir.count);
 
-    for (int i = 0; i < optimizedCount - 1; i++)
+    for (int i = 0; i < ir.count; i++)
     {
-        TACInstruction *cur = &optimizedCode[i];
-        TACInstruction *next = &optimizedCode[i + 1];
-
-        if (cur->result[0] == 't' && strcmp(next->arg1, cur->result) == 0 && strcmp(next->op, "=") == 0)
+        int uses[2];
+        int n = dataflow_use_ids(&assigned.ids, &ir.code[i], uses);
+        for (int k = 0; k < n; k++)
         {
-            snprintf(next->arg1, sizeof(next->arg1), "%s", cur->arg1);
-            snprintf(next->op, sizeof(next->op), "%s", cur->op);
-            snprintf(next->arg2, sizeof(next->arg2), "%s", cur->arg2);
-            cur->result[0] = '\0';
+            int id = uses[k];
+            if (id < assigned.ids.var_count && !bitset_test(&assigned.in[i], id) && !assignedEarlier[id])
+                diag_report(DIAG_SEM_UNINITIALIZED, 0, symbol_table[id].name, symbol_table[id].name);
         }
     }
 
-    int j = 0;
-    for (int i = 0; i < optimizedCount; i++)
-        if (strlen(optimizedCode[i].result) > 0)
-            optimizedCode[j++] = optimizedCode[i];
+    dataflow_free_result(&assigned);
+}
 
-    optimizedCount = j;
+// === Check: variables no instruction defines or reads ===
+static void markReferencedVariables()
+{
+    DataflowIdSpace ids = dataflow_id_space(ir.code, ir.count);
+
+    for (int i = 0; i < ir.count; i++)
+    {
+        int ops[3];
+        int n = dataflow_use_ids(&ids, &ir.code[i], ops);
+        int def = dataflow_def_id(&ids, &ir.code[i]);
+        if (def >= 0)
+            ops[n++] = def;
+        for (int k = 0; k < n; k++)
+            if (ops[k] < ids.var_count)
+                referenced[ops[k]] = 1;
+    }
+}
+
+void check_unused_variables(void)
+{
+    for (int i = 0; i < symbol_count; i++)
+        if (!referenced[i])
+            diag_report(DIAG_SEM_UNUSED, 0, symbol_table[i].name, symbol_table[i].name);
 }
 
 // === Display ===
+static void printInstruction(const TACInstruction *inst)
+{
+    char result[64], arg1[64], arg2[64];
+    tac_operand_text(inst->result, result, sizeof(result));
+    tac_operand_text(inst->arg1, arg1, sizeof(arg1));
+
+    if (inst->op == TAC_COPY)
+        printf("%s = %s\n", result, arg1);
+    else
+        printf("%s = %s %s %s\n", result, arg1, tac_opcode_symbol(inst->op),
+               tac_operand_text(inst->arg2, arg2, sizeof(arg2)));
+}
+
 static void displayTAC()
 {
     printf("===== INTERMEDIATE CODE (TAC) =====\n");
-    for (int i = 0; i < codeCount; i++)
-    {
-        TACInstruction *inst = &code[i];
-        if (strcmp(inst->op, "=") == 0 && strlen(inst->arg2) == 0)
-            printf("%s = %s\n", inst->result, inst->arg1);
-        else
-            printf("%s = %s %s %s\n", inst->result, inst->arg1, inst->op, inst->arg2);
-    }
+    for (int i = 0; i < ir.count; i++)
+        printInstruction(&ir.code[i]);
     printf("===== INTERMEDIATE CODE (TAC) END =====\n\n");
 }
 
@@ -252,33 +417,82 @@ static void displayOptimizedTAC()
 {
     printf("===== OPTIMIZED CODE =====\n");
     for (int i = 0; i < optimizedCount; i++)
-    {
-        TACInstruction *inst = &optimizedCode[i];
-        if (strcmp(inst->op, "=") == 0 && strlen(inst->arg2) == 0)
-            printf("%s = %s\n", inst->result, inst->arg1);
-        else
-            printf("%s = %s %s %s\n", inst->result, inst->arg1, inst->op, inst->arg2);
-    }
+        printInstruction(&optimizedCode[i]);
     printf("===== OPTIMIZED CODE END =====\n\n");
 }
 
 // === Public Interface ===
 void generate_intermediate_code(ASTNode *root)
 {
-    if (code)
-        free(code);
-    if (optimizedCode)
-        free(optimizedCode);
-    code = NULL;
+    // optimizedCode aliases code
+    free(ir.code);
+    memset(&ir, 0, sizeof(ir));
     optimizedCode = NULL;
-    codeCount = 0;
     optimizedCount = 0;
     tempCount = 0;
+    free(wideConstants);
+    wideConstants = NULL;
+    wideConstantCount = 0;
 
     if (root)
+    {
+        tac_buffer_reserve(&ir, estimateInstructions(root));
         generateCode(root);
+    }
 
+    checkUninitializedUses();
+    memset(referenced, 0, sizeof(referenced));
+    markReferencedVariables();
+    check_unused_variables();
     displayTAC();
-    removeRedundantTemporaries();
+    // the passes compact the buffer in place; optimizedCode aliases it
+    int generated = ir.count;
+    reset_pass_stats();
+    run_passes(&ir);
+    print_pass_report();
+    optimizedCode = ir.code;
+    optimizedCount = ir.count;
     displayOptimizedTAC();
+
+    printf("Intermediate Code: %d instruction(s) generated, %d after optimization, %d buffer allocation(s) (capacity %d, %zu bytes).\n\n",
+           generated, optimizedCount, ir.allocations, ir.capacity, sizeof(TACInstruction) * ir.capacity);
+}
+
+/* Streaming: lowers and optimizes one statement's tree without printing
+   anything. Variables keep whatever earlier statements stored, so
+   nothing assumes they start at zero. The code stays valid until the
+   next call. */
+TACInstruction *generate_statement_code(ASTNode *root, int *count)
+{
+    ir.count = 0;
+    tempCount = 0;
+
+    if (root)
+    {
+        tac_buffer_reserve(&ir, estimateInstructions(root));
+        generateCode(root);
+    }
+
+    checkUninitializedUses();
+    markReferencedVariables();
+    for (int i = 0; i < ir.count; i++)
+        if (tac_is_var(ir.code[i].result))
+            assignedEarlier[tac_index(ir.code[i].result)] = 1;
+
+    sccp_set_entry_values_zero(0);
+    run_passes(&ir);
+    sccp_set_entry_values_zero(1);
+
+    optimizedCode = ir.code;
+    optimizedCount = ir.count;
+    *count = ir.count;
+    return ir.code;
+}
+
+// Streaming: drops the wide constants earlier statements' TAC refers to
+void reset_wide_constants(void)
+{
+    free(wideConstants);
+    wideConstants = NULL;
+    wideConstantCount = 0;
 }
@@ -4,9 +4,13 @@ TOKEN tokens[MAX_TOKENS];
 int token_count = 0;
 int error_found = 0;
 
+// source line of the character being scanned, stored with every token
+static int current_line = 1;
+
 int is_datatype(const char *token)
 {
-    return (strcmp(token, "int") == 0 || strcmp(token, "char") == 0);
+    return (strcmp(token, "ENTEGER") == 0 || strcmp(token, "CHAROT") == 0 || strcmp(token, "KUAN") == 0 ||
+            strcmp(token, "int") == 0 || strcmp(token, "char") == 0);
 }
 
 int is_operator_char(char c)
@@ -23,12 +27,13 @@ void add_to_tokens(const char *lexeme, TokenType token_type)
 {
     if (token_count >= MAX_TOKENS)
     {
-        printf("Error adding token: Reached max tokens.\n");
+        diag_report(DIAG_LEX_TOO_MANY_TOKENS, current_line, lexeme);
         error_found = 1;
         return;
     }
 
     tokens[token_count].type = token_type;
+    tokens[token_count].line = current_line;
     strncpy(tokens[token_count].lexeme, lexeme, MAX_VALUE_LENGTH - 1);
     tokens[token_count].lexeme[MAX_VALUE_LENGTH - 1] = '\0';
     token_count++;
@@ -168,11 +173,15 @@ int skip_multi_line_comment(const char *src, int *i)
     *i += 2; // skip "/*"
 
     while (src[*i] != '\0' && !(src[*i] == '*' && src[*i + 1] == '/'))
+    {
+        if (src[*i] == '\n')
+            current_line++;
         (*i)++;
+    }
 
     if (src[*i] == '\0')
     {
-        printf("Error: unclosed multi-line comment\n");
+        diag_report(DIAG_LEX_UNCLOSED_COMMENT, current_line, NULL);
         return 1;
     }
 
@@ -181,24 +190,24 @@ int skip_multi_line_comment(const char *src, int *i)
     return 0;
 }
 
-int lexer(const char *src)
+// scans src into tokens[], numbering lines from first_line; prints nothing
+int lex_source(const char *src, int first_line)
 {
-    printf("\n===== LEXICAL ANALYSIS START =====\n");
-
-    if (!src)
-    {
-        printf("Lexer: source is NULL\n");
-        return 1;
-    }
-
     int len = (int)strlen(src);
 
     // temporary buffer
     char temp_token[MAX_BUFFER_LEN];
     int t_iter = 0;
 
+    token_count = 0;
+    current_line = first_line;
+
     for (int i = 0; i < len; i++)
     {
+        // stop scanning once the error cap is reached
+        if (diag_should_abort())
+            break;
+
         // set current char
         char c = src[i];
 
@@ -208,7 +217,11 @@ int lexer(const char *src)
 
         // Skip whitespace
         if (isspace((unsigned char)c))
+        {
+            if (c == '\n')
+                current_line++;
             continue;
+        }
 
         // Skip comments:
         // case 1 : single comment
@@ -307,7 +320,7 @@ int lexer(const char *src)
                 }
             }
 
-            printf("Lexer Error: Unterminated or invalid character literal\n");
+            diag_report(DIAG_LEX_BAD_CHAR_LITERAL, current_line, NULL);
             error_found = 1;
             continue;
         }
@@ -364,10 +377,26 @@ int lexer(const char *src)
         }
 
         // If we get here, unknown char
-        printf("Lexer Warning: Unknown symbol (ASCII %d) '%c'\n", (unsigned char)c, c);
+        char ascii[8], symbol[2] = {c, '\0'};
+        snprintf(ascii, sizeof(ascii), "%d", (unsigned char)c);
+        diag_report(DIAG_LEX_UNKNOWN_SYMBOL, current_line, NULL, ascii, symbol);
         error_found = 1;
     }
 
+    return error_found;
+}
+
+int lexer(const char *src)
+{
+    printf("\n===== LEXICAL ANALYSIS START =====\n");
+
+    if (!src)
+    {
+        printf("Lexer: source is NULL\n");
+        return 1;
+    }
+
+    lex_source(src, 1);
     display_tokens();
 
     printf("===== LEXICAL ANALYSIS END =====\n");
@@ -2,8 +2,9 @@
 
 int start_code_counter = 0;
 
-const char *R_TYPE[R_TYPE_COUNT] = {"daddu", "dsub", "dmult", "ddiv", "mflo"};
-const char *I_TYPE[I_TYPE_COUNT] = {"daddiu", "ld", "sd"};
+const char *R_TYPE[R_TYPE_COUNT] = {"daddu", "dsub", "dsubu", "dmult", "ddiv", "mflo", "mfhi",
+                                   "dsll", "dsrl", "dsra", "dsll32", "dsrl32", "dsra32"};
+const char *I_TYPE[I_TYPE_COUNT] = {"daddiu", "ld", "sd", "lui", "ori"};
 
 typedef struct
 {
@@ -11,7 +12,7 @@ typedef struct
     int address;
 } DataSymbol;
 
-DataSymbol data_symbols[100];
+DataSymbol data_symbols[1 + MAX_SYMBOLS + MAX_CONSTANT_POOL]; // the .data line, variables, pooled constants
 int data_symbol_count = 0;
 int current_data_address = 0xFFF8; // base address for .data section
 
@@ -37,7 +38,8 @@ void remove_data_and_code_section()
         char *line = assembly_code[i].assembly;
 
         char label[32];
-        if (sscanf(line, "%31[^:]:", label) == 1)
+        if (data_symbol_count < (int)(sizeof(data_symbols) / sizeof(data_symbols[0])) &&
+            sscanf(line, "%31[^:]:", label) == 1)
         {
             trim(label);
             strcpy(data_symbols[data_symbol_count].label, label);
@@ -74,6 +76,8 @@ void convert_to_binary(int num, int bits, char *output)
 
 int parse_register(const char *token)
 {
+    if (strcmp(token, "sp") == 0)
+        return 29;
     if (token[0] == 'r' || token[0] == 'R')
         return atoi(token + 1);
     return 0;
@@ -81,31 +85,50 @@ int parse_register(const char *token)
 
 int get_opcode(const char *mnemonic)
 {
-    if (strcmp(mnemonic, "daddu") == 0)
-        return 0x00;
-    if (strcmp(mnemonic, "dsub") == 0)
-        return 0x00;
-    if (strcmp(mnemonic, "dmult") == 0)
-        return 0x00;
-    if (strcmp(mnemonic, "ddiv") == 0)
-        return 0x00;
-    if (strcmp(mnemonic, "mflo") == 0)
-        return 0x00;
+    // every R-type instruction here is in the SPECIAL group (opcode 0)
+    for (int i = 0; i < R_TYPE_COUNT; i++)
+        if (strcmp(mnemonic, R_TYPE[i]) == 0)
+            return 0x00;
     if (strcmp(mnemonic, "daddiu") == 0)
         return 0x19;
     if (strcmp(mnemonic, "ld") == 0)
         return 0x37;
     if (strcmp(mnemonic, "sd") == 0)
         return 0x3F;
+    if (strcmp(mnemonic, "lui") == 0)
+        return 0x0F;
+    if (strcmp(mnemonic, "ori") == 0)
+        return 0x0D;
     return 0;
 }
 
+int is_shift(const char *mnemonic)
+{
+    return strncmp(mnemonic, "dsll", 4) == 0 || strncmp(mnemonic, "dsrl", 4) == 0 || strncmp(mnemonic, "dsra", 4) == 0;
+}
+
 int get_funct(const char *mnemonic)
 {
     if (strcmp(mnemonic, "daddu") == 0)
         return 0x2D;
     if (strcmp(mnemonic, "dsub") == 0)
         return 0x2E;
+    if (strcmp(mnemonic, "dsubu") == 0)
+        return 0x2F;
+    if (strcmp(mnemonic, "mfhi") == 0)
+        return 0x10;
+    if (strcmp(mnemonic, "dsll") == 0)
+        return 0x38;
+    if (strcmp(mnemonic, "dsrl") == 0)
+        return 0x3A;
+    if (strcmp(mnemonic, "dsra") == 0)
+        return 0x3B;
+    if (strcmp(mnemonic, "dsll32") == 0)
+        return 0x3C;
+    if (strcmp(mnemonic, "dsrl32") == 0)
+        return 0x3E;
+    if (strcmp(mnemonic, "dsra32") == 0)
+        return 0x3F;
     if (strcmp(mnemonic, "dmult") == 0)
         return 0x1C;
     if (strcmp(mnemonic, "ddiv") == 0)
@@ -116,7 +139,146 @@ int get_funct(const char *mnemonic)
 }
 
 
-void convert_to_machine_code() {
+// the line, its fields in binary and the whole word in hex
+static void print_encoded(FILE *out, const char *line, const char *full_bin)
+{
+    // --- Convert Binary String to Hexadecimal ---
+    unsigned int full_bin_value = 0;
+    for (int j = 0; full_bin[j]; j++)
+    {
+        if (full_bin[j] == '1')
+        {
+            full_bin_value = (full_bin_value << 1) | 1;
+        }
+        else if (full_bin[j] == '0')
+        {
+            full_bin_value <<= 1;
+        }
+    }
+
+    // --- Output Binary + Hex ---
+    fprintf(out, "%-20s\t->\t%s\t(0x%08X)\n", line, full_bin, full_bin_value);
+}
+
+// address of a .data label, or the number itself when tok is not one
+static int data_address(const char *tok)
+{
+    for (int d = 0; d < data_symbol_count; d++)
+        if (strcmp(tok, data_symbols[d].label) == 0)
+            return data_symbols[d].address;
+    return atoi(tok); // fallback to numeric
+}
+
+/* 1 if a number fits the field it is encoded in: lui and ori take a
+   16-bit unsigned immediate, the other I-type instructions a signed one,
+   and shifts a 5-bit amount. */
+static int field_fits(const char *mnemonic, long value)
+{
+    if (is_shift(mnemonic))
+        return value >= 0 && value <= 31;
+    if (strcmp(mnemonic, "lui") == 0 || strcmp(mnemonic, "ori") == 0)
+        return value >= 0 && value <= 0xFFFF;
+    return value >= -32768 && value <= 32767;
+}
+
+// === MSA ===
+/* The MSA instructions --msa emits, all on doubleword (.d) elements. They
+   share major opcode 011110 and are printed split into their own fields:
+   MI10 (ld.d/st.d: s10, rs, wd, minor), 3R (operation, df, wt, ws, wd,
+   minor), BIT (operation, df/m, ws, wd, minor) and ELM (copy_s.d:
+   operation, df/n, ws, rd, minor). */
+static const struct
+{
+    const char *mnemonic;
+    char format; // 'M' MI10, 'R' 3R, 'B' BIT, 'E' ELM
+    const char *operation;
+    const char *minor;
+} MSA_TABLE[] = {
+    {"ld.d", 'M', "", "1000"},        {"st.d", 'M', "", "1001"},        {"addv.d", 'R', "000", "001110"},
+    {"subv.d", 'R', "001", "001110"}, {"mulv.d", 'R', "000", "010010"}, {"slli.d", 'B', "000", "001001"},
+    {"srai.d", 'B', "001", "001001"}, {"srli.d", 'B', "010", "001001"}, {"copy_s.d", 'E', "0010", "011001"},
+};
+
+static int parse_vector_register(const char *token)
+{
+    if (token[0] == 'w' || token[0] == 'W')
+        return atoi(token + 1);
+    return 0;
+}
+
+// fills full_bin for an MSA line; returns 0 if the mnemonic is not one
+static int encode_msa(const char *mnemonic, char *operands, char *full_bin, size_t size)
+{
+    int n = -1;
+    for (int k = 0; k < (int)(sizeof(MSA_TABLE) / sizeof(MSA_TABLE[0])); k++)
+        if (strcmp(mnemonic, MSA_TABLE[k].mnemonic) == 0)
+            n = k;
+    if (n < 0)
+        return 0;
+
+    char *save = NULL;
+    char *first = strtok_r(operands, ", ", &save);
+    char *second = first ? strtok_r(NULL, ", ", &save) : NULL;
+    char *third = second ? strtok_r(NULL, ", ", &save) : NULL;
+    if (!second)
+        return 0;
+
+    char bin_a[11], bin_b[8], bin_c[6], bin_d[6];
+    switch (MSA_TABLE[n].format)
+    {
+    case 'M':
+    { // wd, label(rs); the 10-bit offset counts doublewords
+        char *paren = strchr(second, '(');
+        int rs = 0, address = 0;
+        if (paren)
+        {
+            *paren = '\0';
+            trim(second);
+            char *base_reg = paren + 1;
+            base_reg[strcspn(base_reg, ")")] = 0;
+            rs = parse_register(base_reg);
+            address = (short)(data_address(second) & 0xFFFF);
+        }
+        convert_to_binary((address / 8) & 0x3FF, 10, bin_a);
+        convert_to_binary(rs, 5, bin_c);
+        convert_to_binary(parse_vector_register(first), 5, bin_d);
+        snprintf(full_bin, size, "011110 %s %s %s %s 11", bin_a, bin_c, bin_d, MSA_TABLE[n].minor);
+        break;
+    }
+    case 'R': // wd, ws, wt
+        if (!third)
+            return 0;
+        convert_to_binary(parse_vector_register(third), 5, bin_a);
+        convert_to_binary(parse_vector_register(second), 5, bin_c);
+        convert_to_binary(parse_vector_register(first), 5, bin_d);
+        snprintf(full_bin, size, "011110 %s 11 %s %s %s %s", MSA_TABLE[n].operation, bin_a, bin_c, bin_d,
+                 MSA_TABLE[n].minor);
+        break;
+    case 'B': // wd, ws, m; df/m is 0 then the 6-bit amount for doublewords
+        if (!third)
+            return 0;
+        convert_to_binary((int)strtol(third, NULL, 0) & 0x3F, 7, bin_b);
+        convert_to_binary(parse_vector_register(second), 5, bin_c);
+        convert_to_binary(parse_vector_register(first), 5, bin_d);
+        snprintf(full_bin, size, "011110 %s %s %s %s %s", MSA_TABLE[n].operation, bin_b, bin_c, bin_d,
+                 MSA_TABLE[n].minor);
+        break;
+    default: // rd, ws[n]; df/n is 11100 then the element for doublewords
+    {
+        char *bracket = strchr(second, '[');
+        int element = bracket ? atoi(bracket + 1) & 1 : 0;
+        convert_to_binary(parse_vector_register(second), 5, bin_c);
+        convert_to_binary(parse_register(first), 5, bin_d);
+        snprintf(full_bin, size, "011110 %s 11100%d %s %s %s", MSA_TABLE[n].operation, element, bin_c, bin_d,
+                 MSA_TABLE[n].minor);
+        break;
+    }
+    }
+    return 1;
+}
+
+// writes to out; strtok_r keeps it safe to run on several threads at once
+void convert_to_machine_code(FILE *out) {
     
     char mnemonic[32], operands[128];
     char bin_opcode[7], bin_rs[6], bin_rt[6], bin_rd[6], bin_shamt[6], bin_funct[7];
@@ -136,43 +298,73 @@ void convert_to_machine_code() {
 
         trim(operands);
 
+        // --- MSA has formats of its own ---
+        if (strchr(mnemonic, '.'))
+        {
+            if (encode_msa(mnemonic, operands, full_bin, sizeof(full_bin)))
+                print_encoded(out, assembly_code[i].assembly, full_bin);
+            continue;
+        }
+
         int opcode = get_opcode(mnemonic);
         int funct = get_funct(mnemonic);
 
-        int rs = 0, rt = 0, rd = 0, imm = 0;
-        char *tok;
+        int rs = 0, rt = 0, rd = 0, shamt = 0, imm = 0;
+        long number = 0; // the immediate or shift amount written as a number; a label's address is not checked
+        char *tok, *save = NULL;
 
         // --- Tokenize Operands ---
-        if (strcmp(mnemonic, "mflo") == 0){ //SPECIAL R-type (Release 5)
-            tok = strtok(operands, ", ");
+        if (is_shift(mnemonic)){ // SPECIAL R-type: rd, rt, sa
+            tok = strtok_r(operands, ", ", &save);
+            if (tok)
+                rd = parse_register(tok);
+            tok = strtok_r(NULL, ", ", &save);
+            if (tok)
+                rt = parse_register(tok);
+            tok = strtok_r(NULL, ", ", &save);
+            if (tok)
+                number = strtol(tok, NULL, 0);
+            shamt = (int)number;
+        }
+        else if (strcmp(mnemonic, "lui") == 0){ // I-type: rt, imm
+            tok = strtok_r(operands, ", ", &save);
+            if (tok)
+                rt = parse_register(tok);
+            tok = strtok_r(NULL, ", ", &save);
+            if (tok)
+                number = strtol(tok, NULL, 0);
+            imm = (int)number;
+        }
+        else if (strcmp(mnemonic, "mflo") == 0 || strcmp(mnemonic, "mfhi") == 0){ //SPECIAL R-type (Release 5)
+            tok = strtok_r(operands, ", ", &save);
             if (tok)
                 rd = parse_register(tok);
         }
         else if (strcmp(mnemonic, "dmult") == 0 || strcmp(mnemonic, "ddiv") == 0){ //Special R-type (Release 5)
-            tok = strtok(operands, ", ");
+            tok = strtok_r(operands, ", ", &save);
             if (tok)
                 rs = parse_register(tok);
-            tok = strtok(NULL, ", ");
+            tok = strtok_r(NULL, ", ", &save);
             if (tok)
                 rt = parse_register(tok);
         }
         else if (opcode == 0x00){ // R-type
-            tok = strtok(operands, ", ");
+            tok = strtok_r(operands, ", ", &save);
             if (tok)
                 rd = parse_register(tok);
-            tok = strtok(NULL, ", ");
+            tok = strtok_r(NULL, ", ", &save);
             if (tok)
                 rs = parse_register(tok);
-            tok = strtok(NULL, ", ");
+            tok = strtok_r(NULL, ", ", &save);
             if (tok)
                 rt = parse_register(tok);
         }
         else
         { // I-type
-            tok = strtok(operands, ", ");
+            tok = strtok_r(operands, ", ", &save);
             if (tok)
                 rt = parse_register(tok);
-            tok = strtok(NULL, ", ");
+            tok = strtok_r(NULL, ", ", &save);
             if (tok)
             {
                 // check for label(offset)
@@ -186,35 +378,34 @@ void convert_to_machine_code() {
                     rs = parse_register(base_reg);
 
                     // --- Check if tok is a label ---
-                    int found = 0;
-                    for (int d = 0; d < data_symbol_count; d++)
-                    {
-                        if (strcmp(tok, data_symbols[d].label) == 0)
-                        {
-                            imm = data_symbols[d].address;
-                            found = 1;
-                            break;
-                        }
-                    }
-                    if (!found)
-                        imm = atoi(tok); // fallback to numeric
+                    imm = data_address(tok);
+                    if (isdigit((unsigned char)tok[0]) || tok[0] == '-')
+                        number = imm;
                 }
                 else
                 {
                     rs = parse_register(tok);
-                    tok = strtok(NULL, ", ");
+                    tok = strtok_r(NULL, ", ", &save);
                     if (tok)
-                        imm = atoi(tok);
+                        number = strtol(tok, NULL, 0);
+                    imm = (int)number;
                 }
             }
         }
 
+        // a field too narrow for the number would silently change the instruction
+        if (!field_fits(mnemonic, number))
+        {
+            printf("Error: %ld does not fit the immediate field of '%s'\n", number, assembly_code[i].assembly);
+            continue;
+        }
+
         // --- Convert Fields to Binary ---
         convert_to_binary(opcode, 6, bin_opcode);
         convert_to_binary(rs, 5, bin_rs);
         convert_to_binary(rt, 5, bin_rt);
         convert_to_binary(rd, 5, bin_rd);
-        convert_to_binary(0, 5, bin_shamt);
+        convert_to_binary(shamt, 5, bin_shamt);
         convert_to_binary(funct, 6, bin_funct);
         convert_to_binary(imm & 0xFFFF, 16, bin_imm);
 
@@ -224,22 +415,7 @@ void convert_to_machine_code() {
         else
             snprintf(full_bin, sizeof(full_bin), "%s %s %s %s", bin_opcode, bin_rs, bin_rt, bin_imm);
 
-        // --- Convert Binary String to Hexadecimal ---
-        unsigned int full_bin_value = 0;
-        for (int j = 0; j < strlen(full_bin); j++)
-        {
-            if (full_bin[j] == '1')
-            {
-                full_bin_value = (full_bin_value << 1) | 1;
-            }
-            else if (full_bin[j] == '0')
-            {
-                full_bin_value <<= 1;
-            }
-        }
-
-        // --- Output Binary + Hex ---
-        printf("%-20s\t->\t%s\t(0x%08X)\n", assembly_code[i].assembly, full_bin, full_bin_value);
+        print_encoded(out, assembly_code[i].assembly, full_bin);
     }
 }
 
@@ -247,6 +423,25 @@ void generate_machine_code()
 {
     remove_data_and_code_section();
     printf("===== MACHINE CODE =====\n");
-    convert_to_machine_code();
+    convert_to_machine_code(stdout);
     printf("===== MACHINE CODE END =====\n");
 }
+
+// === STREAMING ===
+void add_data_symbol(const char *label)
+{
+    if (data_symbol_count == MAX_SYMBOLS)
+        return;
+    // remove_data_and_code_section() gives the ".data" line the first slot, so variables start one word in
+    if (data_symbol_count == 0)
+        current_data_address += 8;
+    snprintf(data_symbols[data_symbol_count].label, sizeof(data_symbols[0].label), "%s", label);
+    data_symbols[data_symbol_count].address = current_data_address;
+    data_symbol_count++;
+    current_data_address += 8;
+}
+
+void encode_statement_code(FILE *out)
+{
+    convert_to_machine_code(out);
+}
@@ -10,12 +10,166 @@
 #include "headers/intermediate_code_generator.h"
 #include "headers/target_code_generator.h"
 #include "headers/machine_code_generator.h"
+#include "headers/diagnostics.h"
+#include "headers/pass_manager.h"
+#include "headers/tac_file.h"
+#include "headers/stream.h"
+#include "headers/partial_evaluator.h"
+#include "headers/parallel.h"
 
 // lex and yacc api
 #include "lex_and_yacc/api.h"
 
-int main()
+// === COMMAND LINE OPTIONS ===
+static const char *emit_tac_path = NULL;      // binary TAC written after optimization
+static const char *emit_tac_text_path = NULL; // the same, human-readable
+static const char *load_tac_path = NULL;      // skip to the backend with this TAC
+static int streaming = 0;                     // compile one statement at a time
+static int evaluating = 0;                    // run the program now, emit only its final .data
+static int msa = 0;                           // the target has MSA; lay out .data for it
+
+// returns 0 on success, 1 on an unknown or malformed option
+static int parse_options(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+
+        if (strcmp(arg, "--diag-format=text") == 0)
+            diag_set_format(DIAG_FORMAT_TEXT);
+        else if (strcmp(arg, "--diag-format=json") == 0)
+            diag_set_format(DIAG_FORMAT_JSON);
+        else if (strncmp(arg, "--max-errors=", 13) == 0 && atoi(arg + 13) >= 0)
+            diag_set_max_errors(atoi(arg + 13));
+        else if (strcmp(arg, "--keep-data") == 0)
+            set_keep_data(1);
+        else if (strcmp(arg, "--no-superopt") == 0)
+            set_superoptimizer(0);
+        else if (strcmp(arg, "--no-regalloc") == 0)
+            set_register_allocation(0);
+        else if (strcmp(arg, "--no-forwarding") == 0)
+            set_memory_forwarding(0);
+        else if (strcmp(arg, "--msa") == 0)
+        {
+            set_msa(1);
+            msa = 1;
+        }
+        else if (strncmp(arg, "--jobs=", 7) == 0 && atoi(arg + 7) >= 1)
+            set_job_count(atoi(arg + 7));
+        else if (strncmp(arg, "-O", 2) == 0)
+        {
+            if (set_optimization_level(arg + 2))
+            {
+                printf("Error: unknown optimization level '%s' (use -O0, -O1, -O2 or -Os)\n", arg);
+                return 1;
+            }
+        }
+        else if (strncmp(arg, "--emit-tac=", 11) == 0 && arg[11])
+            emit_tac_path = arg + 11;
+        else if (strncmp(arg, "--emit-tac-text=", 16) == 0 && arg[16])
+            emit_tac_text_path = arg + 16;
+        else if (strncmp(arg, "--load-tac=", 11) == 0 && arg[11])
+            load_tac_path = arg + 11;
+        else if (strcmp(arg, "--stream") == 0)
+            streaming = 1;
+        else if (strcmp(arg, "--evaluate") == 0)
+            evaluating = 1;
+        else if (strncmp(arg, "--passes=", 9) == 0)
+        {
+            if (set_pass_list(arg + 9))
+                return 1;
+        }
+        else
+        {
+            printf("Error: unknown option '%s'\n", arg);
+            printf("Usage: %s [--diag-format=text|json] [--max-errors=N] [--keep-data] [--no-superopt] [--no-regalloc]\n"
+                   "       [--no-forwarding] [--msa] [--jobs=N] [-O0|-O1|-O2|-Os] [--passes=a,b,...]\n"
+                   "       [--emit-tac=FILE] [--emit-tac-text=FILE] [--load-tac=FILE] [--stream] [--evaluate]\n", argv[0]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// with --evaluate, the final values when the whole program could run at compile time
+static int evaluate_now(long long *values)
+{
+    printf("===== PARTIAL EVALUATION =====\n");
+    int stopped_at = evaluate_program(optimizedCode, optimizedCount, values);
+    if (stopped_at < 0)
+        printf("%d instruction(s) evaluated; nothing is left to run.\n", optimizedCount);
+    else
+        printf("Instruction %d divides by zero or overflows, which only the hardware can decide; "
+               "generating code instead.\n", stopped_at + 1);
+    printf("===== PARTIAL EVALUATION END =====\n\n");
+    return stopped_at < 0;
+}
+
+// STEP 5 and 6: MIPS64 assembly, then machine code
+static void run_backend(void)
 {
+    long long *values = NULL;
+    if (evaluating)
+    {
+        values = malloc(sizeof(long long) * (symbol_count > 0 ? symbol_count : 1));
+        if (!values)
+        {
+            printf("Error: partial evaluation memory allocation failed.\n");
+            exit(1);
+        }
+    }
+
+    if (values && evaluate_now(values))
+        generate_evaluated_target_code(values);
+    else
+        generate_target_code();
+    generate_machine_code();
+    free(values);
+}
+
+// runs only the backend, on TAC saved by an earlier --emit-tac
+static int run_backend_only(const char *path)
+{
+    optimizedCode = tac_load_binary(path, &optimizedCount);
+    if (!optimizedCode)
+        return 1;
+    printf("Loaded %d TAC instruction(s) and %d symbol(s) from '%s'.\n\n", optimizedCount, symbol_count, path);
+
+    run_backend();
+
+    printf("\n===== SYMBOL TABLE (FROM TAC FILE) =====\n");
+    display_symbol_table();
+
+    tac_unload();
+    optimizedCode = NULL;
+    optimizedCount = 0;
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (parse_options(argc, argv))
+        return 1;
+
+    if (load_tac_path)
+        return run_backend_only(load_tac_path);
+    if (streaming)
+    {
+        // there is never a whole program's TAC to save or run
+        if (emit_tac_path || emit_tac_text_path || evaluating)
+        {
+            printf("Error: --emit-tac and --evaluate cannot be combined with --stream\n");
+            return 1;
+        }
+        // .data is laid out in first-use order before later statements are seen
+        if (msa)
+        {
+            printf("Error: --msa cannot be combined with --stream\n");
+            return 1;
+        }
+        return compile_streaming("input.txt");
+    }
+
     // === STEP 0: READ SOURCE CODE ===
     FILE *fp = fopen("input.txt", "r");
     if (fp == NULL)
@@ -50,6 +204,7 @@ int main()
     // === STEP 1: LEXICAL ANALYSIS ===
     if (lexer(source_code))
     {
+        diag_flush();
         printf("Compilation stopped: Lexical errors found.\n");
         free(source_code);
         return 0;
@@ -60,34 +215,43 @@ int main()
     int syntax_status = syntax_analyzer();
     if (syntax_status != 0)
     {
+        diag_flush();
         printf("\nCompilation aborted due to syntax error.\n");
         free(source_code);
         return 0;
     }
 
-    // // === STEP 3: SEMANTIC ANALYSIS ===
-    // printf("====== SEMANTIC ANALYZER ======\n");
-    // int semantic_status = semantic_analyzer();
-    // if (semantic_status != 0)
-    // {
-    //     printf("\nCompilation aborted due to semantic error.\n");
-    //     free(source_code);
-    //     return 0;
-    // }
-    // printf("====== SEMANTIC ANALYZER END ======\n\n");
-
-    // // === STEP 4: INTERMEDIATE CODE GENERATION ===
-    // generate_intermediate_code(syntax_tree);
-
-    // // === STEP 5: TARGET CODE (MIPS64) ===
-    // generate_target_code();
-
-    // // === STEP 6: MACHINE CODE GENERATION ===
-    // generate_machine_code();
-
-    // // === SYMBOL TABLE ===
-    // printf("\n===== SYMBOL TABLE (AFTER ANALYSIS) =====\n");
-    // display_symbol_table();
+    // === STEP 3: SEMANTIC ANALYSIS ===
+    printf("====== SEMANTIC ANALYZER ======\n");
+    int semantic_status = semantic_analyzer();
+    if (semantic_status != 0)
+    {
+        diag_flush();
+        if (diag_should_abort())
+            printf("\nToo many errors (limit reached).\n");
+        printf("\nCompilation aborted due to semantic error.\n");
+        free(source_code);
+        return 0;
+    }
+    printf("====== SEMANTIC ANALYZER END ======\n\n");
+
+    // === STEP 4: INTERMEDIATE CODE GENERATION ===
+    generate_intermediate_code(syntax_tree);
+
+    // every diagnostic is known by now; report them in one write
+    diag_flush();
+
+    if (emit_tac_path && tac_write_binary(emit_tac_path, optimizedCode, optimizedCount))
+        return 1;
+    if (emit_tac_text_path && tac_write_text(emit_tac_text_path, optimizedCode, optimizedCount))
+        return 1;
+
+    // === STEP 5 AND 6: TARGET CODE (MIPS64) AND MACHINE CODE ===
+    run_backend();
+
+    // === SYMBOL TABLE ===
+    printf("\n===== SYMBOL TABLE (AFTER ANALYSIS) =====\n");
+    display_symbol_table();
 
     // === CLEANUP ===
     free(source_code);
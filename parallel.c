@@ -0,0 +1,84 @@
+// parallel.c
+#include "headers/parallel.h"
+#include <pthread.h>
+
+static int jobs = 1;
+
+void set_job_count(int count)
+{
+    jobs = count < 1 ? 1 : count > MAX_JOBS ? MAX_JOBS : count;
+}
+
+int job_count(void)
+{
+    return jobs;
+}
+
+// === WORKER POOL ===
+// the threads start on first use and then wait for the next round of work
+static pthread_t threads[MAX_JOBS];
+static int thread_count = 0;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t work_done = PTHREAD_COND_INITIALIZER;
+
+static ParallelTask current_task = NULL;
+static void *current_arg = NULL;
+static int current_slots = 0;
+static int round_number = 0; // bumped for each parallel_run()
+static int busy = 0;         // threads still working on this round
+
+static void *run_worker(void *p)
+{
+    int slot = (int)(long)p;
+    int seen = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pool_lock);
+        while (round_number == seen)
+            pthread_cond_wait(&work_ready, &pool_lock);
+        seen = round_number;
+        ParallelTask task = current_task;
+        void *arg = current_arg;
+        int run = slot < current_slots;
+        pthread_mutex_unlock(&pool_lock);
+
+        if (run)
+            task(slot, arg);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--busy == 0)
+            pthread_cond_signal(&work_done);
+        pthread_mutex_unlock(&pool_lock);
+    }
+    return NULL;
+}
+
+void parallel_run(int slots, ParallelTask task, void *arg)
+{
+    pthread_mutex_lock(&pool_lock);
+
+    // every slot runs on a pool thread, so none of them shares the caller's assembly lines
+    while (thread_count < slots)
+    {
+        if (pthread_create(&threads[thread_count], NULL, run_worker, (void *)(long)thread_count) != 0)
+        {
+            fprintf(stderr, "Unable to start a worker thread in parallel_run()\n");
+            exit(1);
+        }
+        thread_count++;
+    }
+
+    current_task = task;
+    current_arg = arg;
+    current_slots = slots;
+    busy = thread_count;
+    round_number++;
+    pthread_cond_broadcast(&work_ready);
+
+    while (busy > 0)
+        pthread_cond_wait(&work_done, &pool_lock);
+    pthread_mutex_unlock(&pool_lock);
+}
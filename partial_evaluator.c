@@ -0,0 +1,45 @@
+// partial_evaluator.c
+#include "headers/partial_evaluator.h"
+#include "headers/dataflow.h"
+#include "headers/ssa.h"
+
+static long long operand_value(TACOperand o, const long long *values, const long long *temps)
+{
+    if (tac_is_var(o))
+        return values[tac_index(o)];
+    if (tac_is_temp(o))
+        return temps[tac_index(o)];
+    return tac_const_value(o);
+}
+
+int evaluate_program(const TACInstruction *code, int count, long long *values)
+{
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    long long *temps = calloc(ids.temp_count > 0 ? ids.temp_count : 1, sizeof(long long));
+    if (!temps)
+    {
+        fprintf(stderr, "Memory allocation failed in evaluate_program()\n");
+        exit(1);
+    }
+
+    memset(values, 0, sizeof(long long) * symbol_count);
+
+    int stopped_at = -1;
+    for (int i = 0; i < count && stopped_at < 0; i++)
+    {
+        const TACInstruction *ins = &code[i];
+        long long a = operand_value(ins->arg1, values, temps);
+        long long b = ins->op == TAC_COPY ? 0 : operand_value(ins->arg2, values, temps);
+        long long r;
+
+        if (!tac_fold(ins->op, a, b, &r))
+            stopped_at = i;
+        else if (tac_is_var(ins->result))
+            values[tac_index(ins->result)] = r;
+        else
+            temps[tac_index(ins->result)] = r;
+    }
+
+    free(temps);
+    return stopped_at;
+}
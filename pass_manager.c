@@ -0,0 +1,215 @@
+// pass_manager.c
+#include <time.h>
+#include "headers/pass_manager.h"
+#include "headers/ssa.h"
+#include "headers/gvn.h"
+#include "headers/copy_propagation.h"
+#include "headers/dce.h"
+#include "headers/reassociation.h"
+#include "headers/strength_reduction.h"
+
+// === PASSES ===
+static ReassociationStats reassociation; // over the rounds of one run_passes()
+
+static int run_sccp(TACBuffer *ir) { return sccp_optimize(ir->code, &ir->count); }
+
+static int run_gvn(TACBuffer *ir) { return gvn_optimize(ir->code, &ir->count); }
+
+static int run_copy_propagation(TACBuffer *ir) { return copy_propagate(ir->code, &ir->count); }
+
+static int run_dce(TACBuffer *ir) { return dce_optimize(ir->code, &ir->count); }
+
+static int run_coalescing(TACBuffer *ir) { return coalesce_copies(ir->code, &ir->count); }
+
+static int run_reassociation(TACBuffer *ir)
+{
+    ReassociationStats s = reassociate(ir);
+    if (s.trees)
+    {
+        if (!reassociation.trees)
+            reassociation.height_before = s.height_before;
+        reassociation.height_after = s.height_after;
+        reassociation.trees += s.trees;
+    }
+    return s.trees;
+}
+
+static int run_strength_reduction(TACBuffer *ir) { return strength_reduce(ir); }
+
+static const PassInfo passes[] = {
+    {"sccp", run_sccp},
+    {"gvn", run_gvn},
+    {"copyprop", run_copy_propagation},
+    {"dce", run_dce},
+    {"coalesce", run_coalescing},
+    {"reassociate", run_reassociation},
+    {"strength", run_strength_reduction},
+};
+
+#define PASS_COUNT ((int)(sizeof(passes) / sizeof(passes[0])))
+
+// === PIPELINE ===
+typedef struct
+{
+    const char *name;
+    const char *passes;
+    int iterate; // repeat until a round changes nothing
+} OptimizationLevel;
+
+static const OptimizationLevel levels[] = {
+    {"0", "", 0},
+    {"1", "sccp,gvn,copyprop,dce,coalesce,strength", 0},
+    {"2", "sccp,gvn,copyprop,dce,coalesce,reassociate,strength", 1},
+    {"s", "sccp,gvn,copyprop,dce,coalesce", 1},
+};
+
+static int pipeline[PASS_MAX_PIPELINE];
+static int pipelineLength = -1; // -1 until a level or list is chosen
+static int pipelineIterates = 0;
+static char pipelineName[32] = "-O1";
+
+static int find_pass(const char *name, size_t length)
+{
+    for (int p = 0; p < PASS_COUNT; p++)
+        if (strlen(passes[p].name) == length && strncmp(passes[p].name, name, length) == 0)
+            return p;
+    return -1;
+}
+
+// fills the pipeline from a comma-separated list; returns 1 on an unknown name
+static int parse_pipeline(const char *list)
+{
+    int length = 0;
+    const char *p = list;
+    while (*p)
+    {
+        const char *end = strchr(p, ',');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        int pass = find_pass(p, n);
+        if (pass < 0 || length == PASS_MAX_PIPELINE)
+        {
+            if (pass < 0)
+                printf("Error: unknown pass '%.*s'\n", (int)n, p);
+            else
+                printf("Error: more than %d passes\n", PASS_MAX_PIPELINE);
+            printf("Available passes:");
+            for (int k = 0; k < PASS_COUNT; k++)
+                printf(" %s", passes[k].name);
+            printf("\n");
+            return 1;
+        }
+        pipeline[length++] = pass;
+        p = end ? end + 1 : p + n;
+    }
+    pipelineLength = length;
+    return 0;
+}
+
+int set_optimization_level(const char *level)
+{
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+    {
+        if (strcmp(levels[l].name, level) != 0)
+            continue;
+        parse_pipeline(levels[l].passes);
+        pipelineIterates = levels[l].iterate;
+        snprintf(pipelineName, sizeof(pipelineName), "-O%s", level);
+        return 0;
+    }
+    return 1;
+}
+
+int set_pass_list(const char *list)
+{
+    if (parse_pipeline(list))
+        return 1;
+    pipelineIterates = 0;
+    snprintf(pipelineName, sizeof(pipelineName), "--passes");
+    return 0;
+}
+
+// === RUNNING ===
+typedef struct
+{
+    long long runs; // long: a streamed program runs the pipeline once per statement
+    long long changes;
+    long long instructions; // net change in instruction count
+    double seconds;
+} PassStats;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// totals since reset_pass_stats(); a streamed program adds one run per statement
+static PassStats stats[PASS_MAX_PIPELINE];
+static long long pipelineRuns = 0;
+static long long totalRounds = 0;
+static ReassociationStats reassociationTotal;
+
+void reset_pass_stats(void)
+{
+    memset(stats, 0, sizeof(stats));
+    memset(&reassociationTotal, 0, sizeof(reassociationTotal));
+    pipelineRuns = 0;
+    totalRounds = 0;
+}
+
+void run_passes(TACBuffer *ir)
+{
+    if (pipelineLength < 0)
+        set_optimization_level("1");
+    memset(&reassociation, 0, sizeof(reassociation));
+
+    int rounds = 0;
+    int changed = 1;
+    while (changed && rounds < (pipelineIterates ? PASS_MAX_ITERATIONS : 1))
+    {
+        changed = 0;
+        rounds++;
+        for (int k = 0; k < pipelineLength; k++)
+        {
+            int before = ir->count;
+            double start = now();
+            int changes = passes[pipeline[k]].run(ir);
+            stats[k].seconds += now() - start;
+            stats[k].runs++;
+            stats[k].changes += changes;
+            stats[k].instructions += ir->count - before;
+            if (changes)
+                changed = 1;
+        }
+    }
+
+    pipelineRuns++;
+    totalRounds += rounds;
+    reassociationTotal.trees += reassociation.trees;
+    if (reassociation.height_before > reassociationTotal.height_before)
+        reassociationTotal.height_before = reassociation.height_before;
+    if (reassociation.height_after > reassociationTotal.height_after)
+        reassociationTotal.height_after = reassociation.height_after;
+}
+
+void print_pass_report(void)
+{
+    if (pipelineRuns > 1)
+        printf("===== PASS REPORT (%s, %lld round(s) over %lld runs) =====\n", pipelineName, totalRounds, pipelineRuns);
+    else
+        printf("===== PASS REPORT (%s, %lld round(s)) =====\n", pipelineName, totalRounds);
+    printf("%-12s %5s %8s %8s %10s\n", "pass", "runs", "changes", "delta", "time (us)");
+    double total = 0;
+    for (int k = 0; k < pipelineLength; k++)
+    {
+        printf("%-12s %5lld %8lld %+8lld %10.1f\n", passes[pipeline[k]].name, stats[k].runs, stats[k].changes,
+               stats[k].instructions, stats[k].seconds * 1e6);
+        total += stats[k].seconds;
+    }
+    printf("%-12s %5s %8s %8s %10.1f\n", "total", "", "", "", total * 1e6);
+    if (reassociationTotal.trees)
+        printf("reassociate: %d expression tree(s) rebalanced, critical path %d -> %d instruction(s)\n",
+               reassociationTotal.trees, reassociationTotal.height_before, reassociationTotal.height_after);
+    printf("===== PASS REPORT END =====\n\n");
+}
@@ -0,0 +1,380 @@
+// reassociation.c
+#include "headers/reassociation.h"
+
+typedef struct
+{
+    TACOperand operand;
+    int negative; // subtracted rather than added (+/- trees only)
+    int depth;    // length of the dependency chain that produces it
+    int reader;   // member instruction that reads it
+} Leaf;
+
+typedef struct
+{
+    TACInstruction *code;
+    int count;
+    int capacity;
+    int next_temp;
+} Output;
+
+typedef struct
+{
+    const TACInstruction *code;
+    DataflowIdSpace ids;
+    int *def_at;      // per temporary: defining instruction, -2 if several
+    char *internal;   // per instruction: feeds the next node of its tree
+    const int *ready; // per dataflow id: depth of its current value
+    Leaf *leaves;
+    int leaf_count;
+    int *members; // instructions making up the tree, root included
+    int member_count;
+} Tree;
+
+static void *reassoc_alloc(size_t size)
+{
+    void *p = calloc(1, size > 0 ? size : 1);
+    if (!p)
+    {
+        fprintf(stderr, "Memory allocation failed in reassociate()\n");
+        exit(1);
+    }
+    return p;
+}
+
+static void append(Output *out, TACOpcode op, TACOperand result, TACOperand arg1, TACOperand arg2)
+{
+    if (out->count == out->capacity)
+    {
+        out->capacity = out->capacity ? out->capacity * 2 : 64;
+        TACInstruction *tmp = realloc(out->code, sizeof(TACInstruction) * out->capacity);
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed in reassociate()\n");
+            exit(1);
+        }
+        out->code = tmp;
+    }
+    TACInstruction *ins = &out->code[out->count++];
+    ins->op = op;
+    ins->result = result;
+    ins->arg1 = arg1;
+    ins->arg2 = arg2;
+}
+
+// === DEPTH ===
+// depth of the value ins computes, given the depths of its operands
+static int depth_of(const DataflowIdSpace *ids, const int *ready, const TACInstruction *ins)
+{
+    int uses[2];
+    int n = dataflow_use_ids(ids, ins, uses);
+    int depth = 0;
+    for (int k = 0; k < n; k++)
+        if (ready[uses[k]] > depth)
+            depth = ready[uses[k]];
+
+    // copies only rename a value
+    return ins->op == TAC_COPY ? depth : depth + 1;
+}
+
+static int advance(const DataflowIdSpace *ids, int *ready, const TACInstruction *ins)
+{
+    int depth = depth_of(ids, ready, ins);
+    int def = dataflow_def_id(ids, ins);
+    if (def >= 0)
+        ready[def] = depth;
+    return depth;
+}
+
+// longest chain of instructions each reading the previous one's result
+static int critical_path(const TACInstruction *code, int count)
+{
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    int *ready = reassoc_alloc(sizeof(int) * (dataflow_id_count(&ids) + 1));
+    int longest = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        int depth = advance(&ids, ready, &code[i]);
+        if (depth > longest)
+            longest = depth;
+    }
+
+    free(ready);
+    return longest;
+}
+
+// === TREES ===
+// 1 for + and -, 2 for *, 0 for everything that does not reassociate
+static int op_class(unsigned int op)
+{
+    if (op == TAC_ADD || op == TAC_SUB)
+        return 1;
+    if (op == TAC_MUL)
+        return 2;
+    return 0;
+}
+
+static int internal_child(const Tree *t, TACOperand operand)
+{
+    if (!tac_is_temp(operand))
+        return -1;
+    int d = t->def_at[tac_index(operand)];
+    return d >= 0 && t->internal[d] ? d : -1;
+}
+
+// gathers the members and leaves of the tree under instruction i
+static void collect(Tree *t, int i, int negative)
+{
+    const TACInstruction *ins = &t->code[i];
+    t->members[t->member_count++] = i;
+
+    TACOperand args[2] = {ins->arg1, ins->arg2};
+    for (int k = 0; k < 2; k++)
+    {
+        int sign = negative ^ (k == 1 && ins->op == TAC_SUB);
+        int child = internal_child(t, args[k]);
+        if (child >= 0)
+        {
+            collect(t, child, sign);
+            continue;
+        }
+        int id = dataflow_operand_id(&t->ids, args[k]);
+        Leaf *leaf = &t->leaves[t->leaf_count++];
+        leaf->operand = args[k];
+        leaf->negative = sign;
+        leaf->depth = id >= 0 ? t->ready[id] : 0;
+        leaf->reader = i;
+    }
+}
+
+// a leaf written after a member reads it but before the root, where the rebuilt tree reads it
+static int leaf_clobbered(const Tree *t, int root)
+{
+    for (int k = 0; k < t->leaf_count; k++)
+    {
+        const Leaf *leaf = &t->leaves[k];
+        if (tac_is_const(leaf->operand))
+            continue;
+        for (int i = leaf->reader; i < root; i++)
+            if (t->code[i].result == leaf->operand)
+                return 1;
+    }
+    return 0;
+}
+
+// index of the shallowest item other than skip
+static int shallowest(const Leaf *items, int n, int skip)
+{
+    int best = -1;
+    for (int k = 0; k < n; k++)
+        if (k != skip && (best < 0 || items[k].depth < items[best].depth))
+            best = k;
+    return best;
+}
+
+/* Folds the constant leaves into one, then keeps combining the two
+   operands that are ready first, the way a Huffman tree is built, so a
+   leaf at the end of a long chain is combined last instead of holding up
+   everything above it. Signs ride along: +x and -y combine as x - y, and
+   the total is negated only when every operand was subtracted. Returns
+   the depth of the rebuilt root; when emit is set, writes it to out with
+   result as its last write. */
+static int rebuild(const Tree *t, int cls, TACOperand result, Output *out, int emit)
+{
+    Leaf *items = reassoc_alloc(sizeof(Leaf) * (t->leaf_count + 1));
+    int n = 0;
+    unsigned long long c = cls == 1 ? 0 : 1;
+
+    for (int k = 0; k < t->leaf_count; k++)
+    {
+        const Leaf *leaf = &t->leaves[k];
+        if (!tac_is_const(leaf->operand))
+        {
+            items[n++] = *leaf;
+            continue;
+        }
+        unsigned long long v = (unsigned long long)tac_const_value(leaf->operand);
+        if (cls == 1)
+            c = leaf->negative ? c - v : c + v;
+        else
+            c *= v;
+    }
+
+    if (cls == 2 && c == 0)
+        n = 0; // x * 0 is 0 whatever x is
+    if (n == 0 || (cls == 1 ? c != 0 : c != 1))
+    {
+        items[n].operand = tac_const((long long)c);
+        items[n].negative = 0;
+        items[n].depth = 0;
+        items[n].reader = -1;
+        n++;
+    }
+
+    int before = out->count;
+    while (n > 1)
+    {
+        int a = shallowest(items, n, -1);
+        int b = shallowest(items, n, a);
+        Leaf x = items[a], y = items[b];
+        if (x.negative && !y.negative)
+        {
+            Leaf swap = x;
+            x = y;
+            y = swap;
+        }
+
+        Leaf combined;
+        combined.negative = x.negative && y.negative;
+        combined.depth = (x.depth > y.depth ? x.depth : y.depth) + 1;
+        combined.operand = TAC_NO_OPERAND;
+        combined.reader = -1;
+        if (emit)
+        {
+            combined.operand = tac_temp(out->next_temp++);
+            append(out, cls == 2 ? TAC_MUL : x.negative == y.negative ? TAC_ADD : TAC_SUB,
+                   combined.operand, x.operand, y.operand);
+        }
+
+        int lo = a < b ? a : b, hi = a < b ? b : a;
+        items[lo] = combined;
+        items[hi] = items[--n];
+    }
+
+    Leaf final = items[0];
+    int depth = final.negative ? final.depth + 1 : final.depth;
+    if (emit)
+    {
+        if (final.negative)
+            append(out, TAC_SUB, result, tac_const(0), final.operand);
+        else if (out->count > before && out->code[out->count - 1].result == final.operand)
+            out->code[out->count - 1].result = result; // the last combine writes result itself
+        else
+            append(out, TAC_COPY, result, final.operand, TAC_NO_OPERAND);
+    }
+
+    free(items);
+    return depth;
+}
+
+// === PASS ===
+ReassociationStats reassociate(TACBuffer *ir)
+{
+    ReassociationStats stats = {0, 0, 0};
+    int n = ir->count;
+    if (n == 0)
+        return stats;
+
+    Tree t;
+    t.code = ir->code;
+    t.ids = dataflow_id_space(ir->code, n);
+    int temps = t.ids.temp_count;
+    int nids = dataflow_id_count(&t.ids);
+
+    t.def_at = reassoc_alloc(sizeof(int) * (temps + 1));
+    int *uses = reassoc_alloc(sizeof(int) * (temps + 1));
+    int *consumer = reassoc_alloc(sizeof(int) * (temps + 1));
+    for (int k = 0; k < temps; k++)
+        t.def_at[k] = -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        const TACInstruction *ins = &ir->code[i];
+        if (tac_is_temp(ins->result))
+        {
+            int k = tac_index(ins->result);
+            t.def_at[k] = t.def_at[k] == -1 ? i : -2;
+        }
+        TACOperand args[2] = {ins->arg1, ins->arg2};
+        for (int a = 0; a < 2; a++)
+            if (tac_is_temp(args[a]))
+            {
+                uses[tac_index(args[a])]++;
+                consumer[tac_index(args[a])] = i;
+            }
+    }
+
+    // a node is internal when its single-use temporary feeds a node of the same kind
+    t.internal = reassoc_alloc(n);
+    for (int i = 0; i < n; i++)
+    {
+        const TACInstruction *ins = &ir->code[i];
+        if (!op_class(ins->op) || !tac_is_temp(ins->result))
+            continue;
+        int k = tac_index(ins->result);
+        t.internal[i] = t.def_at[k] == i && uses[k] == 1 && op_class(ir->code[consumer[k]].op) == op_class(ins->op);
+    }
+
+    /* Decide per root first, since its members come before it and are
+       dropped when it is rebuilt. Depths are tracked over the original
+       code in both walks, so each rebuild sees the same leaf depths. */
+    char *rebuild_root = reassoc_alloc(n);
+    char *dropped = reassoc_alloc(n);
+    int *ready = reassoc_alloc(sizeof(int) * (nids + 1));
+    t.ready = ready;
+    t.leaves = reassoc_alloc(sizeof(Leaf) * (n + 1) * 2);
+    t.members = reassoc_alloc(sizeof(int) * n);
+    Output out = {NULL, 0, 0, temps};
+
+    for (int i = 0; i < n; i++)
+    {
+        const TACInstruction *ins = &ir->code[i];
+        int cls = op_class(ins->op);
+        if (cls && !t.internal[i])
+        {
+            t.leaf_count = t.member_count = 0;
+            collect(&t, i, 0);
+
+            int constants = 0;
+            for (int k = 0; k < t.leaf_count; k++)
+                constants += tac_is_const(t.leaves[k].operand);
+
+            if (t.leaf_count >= 3 && !leaf_clobbered(&t, i) &&
+                (rebuild(&t, cls, ins->result, &out, 0) < depth_of(&t.ids, ready, ins) || constants >= 2))
+            {
+                rebuild_root[i] = 1;
+                for (int m = 0; m < t.member_count; m++)
+                    if (t.members[m] != i)
+                        dropped[t.members[m]] = 1;
+                stats.trees++;
+            }
+        }
+        advance(&t.ids, ready, ins);
+    }
+
+    stats.height_before = stats.height_after = critical_path(ir->code, n);
+    if (stats.trees)
+    {
+        memset(ready, 0, sizeof(int) * (nids + 1));
+        for (int i = 0; i < n; i++)
+        {
+            const TACInstruction *ins = &ir->code[i];
+            if (rebuild_root[i])
+            {
+                t.leaf_count = t.member_count = 0;
+                collect(&t, i, 0);
+                rebuild(&t, op_class(ins->op), ins->result, &out, 1);
+            }
+            else if (!dropped[i])
+                append(&out, ins->op, ins->result, ins->arg1, ins->arg2);
+            advance(&t.ids, ready, ins);
+        }
+
+        tac_buffer_reserve(ir, out.count);
+        memcpy(ir->code, out.code, sizeof(TACInstruction) * out.count);
+        ir->count = out.count;
+        stats.height_after = critical_path(ir->code, ir->count);
+    }
+
+    free(out.code);
+    free(t.def_at);
+    free(uses);
+    free(consumer);
+    free(t.internal);
+    free(ready);
+    free(t.leaves);
+    free(t.members);
+    free(rebuild_root);
+    free(dropped);
+    return stats;
+}
@@ -0,0 +1,327 @@
+// register_allocator.c
+#include "headers/register_allocator.h"
+
+// === LIVE INTERVALS ===
+static void touch(RegisterPlan *plan, int id, int position, int write)
+{
+    if (plan->start[id] < 0 || position < plan->start[id])
+    {
+        plan->start[id] = position;
+        plan->copied_from[id] = -1;
+    }
+    if (position > plan->end[id])
+        plan->end[id] = position;
+    if (write)
+        plan->dirty[id] = 1;
+}
+
+static void find_intervals(RegisterPlan *plan, const TACInstruction *code, int count, const int *position,
+                           const char *hidden, const char *in_memory)
+{
+    for (int i = 0; i < count; i++)
+    {
+        int at = position ? position[i] : i;
+        const TACOperand operands[3] = {code[i].arg1, code[i].arg2, code[i].result};
+        for (int k = 0; k < 3; k++)
+        {
+            int id = dataflow_operand_id(&plan->ids, operands[k]);
+            if (id < 0 || (id < plan->ids.var_count && in_memory && in_memory[id]))
+                continue;
+            // a hidden instruction's temporaries never leave the sequence computing it
+            if (hidden && hidden[i] && (k == 2 || id >= plan->ids.var_count))
+                continue;
+            touch(plan, id, at, k == 2);
+        }
+
+        // a copy that starts its target's interval can hand the source's register over
+        int source = dataflow_operand_id(&plan->ids, code[i].arg1);
+        int target = dataflow_def_id(&plan->ids, &code[i]);
+        if (code[i].op == TAC_COPY && source >= 0 && target >= 0 && source != target && plan->start[source] >= 0 &&
+            plan->start[target] == at && !(hidden && hidden[i]))
+            plan->copied_from[target] = source;
+    }
+}
+
+/* Finds the temporaries that can be computed straight into the register
+   of the variable a copy later gives them to: the temporary dies at that
+   copy, and the variable holds nothing anyone reads from the temporary's
+   start up to it. References are visited in position order. */
+static void find_copy_targets(RegisterPlan *plan, const TACInstruction *code, int count, const int *position,
+                              const char *hidden, const char *in_memory)
+{
+    int *bucket = calloc(count + 1, sizeof(int));
+    int *event = malloc(sizeof(int) * (3 * count + 1)); // instruction * 3 + operand
+    int *last_ref = malloc(sizeof(int) * (plan->ids.var_count > 0 ? plan->ids.var_count : 1));
+    if (!bucket || !event || !last_ref)
+    {
+        fprintf(stderr, "Memory allocation failed in regalloc_plan()\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < count; i++)
+        bucket[(position ? position[i] : i) + 1] += 3;
+    for (int at = 0; at < count; at++)
+        bucket[at + 1] += bucket[at];
+    for (int i = 0; i < count; i++)
+        for (int k = 0; k < 3; k++)
+            event[bucket[position ? position[i] : i]++] = 3 * i + k;
+
+    for (int v = 0; v < plan->ids.var_count; v++)
+        last_ref[v] = -1;
+    for (int n = 0; n < 3 * count; n++)
+    {
+        int i = event[n] / 3, k = event[n] % 3;
+        const TACOperand operands[3] = {code[i].arg1, code[i].arg2, code[i].result};
+        int v = dataflow_operand_id(&plan->ids, operands[k]);
+        if (v < 0 || v >= plan->ids.var_count || (in_memory && in_memory[v]) ||
+            (hidden && hidden[i] && k == 2))
+            continue;
+
+        int t = dataflow_operand_id(&plan->ids, code[i].arg1);
+        if (k == 2 && code[i].op == TAC_COPY && tac_is_temp(code[i].arg1) && !(hidden && hidden[i]) &&
+            plan->end[t] == (position ? position[i] : i) && last_ref[v] >= 0 && last_ref[v] <= plan->start[t])
+            plan->copied_into[t] = v;
+        last_ref[v] = position ? position[i] : i;
+    }
+
+    free(bucket);
+    free(event);
+    free(last_ref);
+}
+
+// === LINEAR SCAN ===
+static _Thread_local const RegisterPlan *sorting; // qsort has no context argument
+
+static int by_start(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    if (sorting->start[x] != sorting->start[y])
+        return sorting->start[x] - sorting->start[y];
+    return x - y;
+}
+
+/* Of the active intervals and the new one, the one to go without a
+   register: the variable that ends last, or the temporary that ends last
+   if no variable is involved. */
+static int pick_spill(const RegisterPlan *plan, const int *active, int active_count, int current)
+{
+    int victim = current;
+    for (int a = 0; a < active_count; a++)
+    {
+        int id = active[a];
+        int id_var = id < plan->ids.var_count, victim_var = victim < plan->ids.var_count;
+        if (id_var != victim_var ? id_var : plan->end[id] > plan->end[victim])
+            victim = id;
+    }
+    return victim;
+}
+
+RegisterPlan regalloc_plan(const TACInstruction *code, int count, const int *position, const char *hidden,
+                           const char *in_memory)
+{
+    RegisterPlan plan;
+    plan.ids = dataflow_id_space(code, count);
+    int ids = dataflow_id_count(&plan.ids);
+    int size = ids > 0 ? ids : 1;
+    plan.reg = malloc(sizeof(int) * size);
+    plan.start = malloc(sizeof(int) * size);
+    plan.end = malloc(sizeof(int) * size);
+    plan.dirty = calloc(size, 1);
+    plan.copied_from = malloc(sizeof(int) * size);
+    plan.copied_into = malloc(sizeof(int) * size);
+    int *order = malloc(sizeof(int) * size);
+    if (!plan.reg || !plan.start || !plan.end || !plan.dirty || !plan.copied_from || !plan.copied_into || !order)
+    {
+        fprintf(stderr, "Memory allocation failed in regalloc_plan()\n");
+        exit(1);
+    }
+    for (int id = 0; id < ids; id++)
+        plan.reg[id] = plan.start[id] = plan.end[id] = plan.copied_from[id] = plan.copied_into[id] = -1;
+    find_intervals(&plan, code, count, position, hidden, in_memory);
+    find_copy_targets(&plan, code, count, position, hidden, in_memory);
+
+    int intervals = 0;
+    for (int id = 0; id < ids; id++)
+        if (plan.start[id] >= 0)
+            order[intervals++] = id;
+    sorting = &plan;
+    qsort(order, intervals, sizeof(int), by_start);
+
+    unsigned int free_set = (1u << REGALLOC_REGISTERS) - 1;
+    int active[REGALLOC_REGISTERS];
+    int active_count = 0;
+    for (int n = 0; n < intervals; n++)
+    {
+        int current = order[n];
+
+        // intervals ending before this one starts give their registers back
+        for (int a = 0; a < active_count;)
+        {
+            if (plan.end[active[a]] < plan.start[current])
+            {
+                free_set |= 1u << plan.reg[active[a]];
+                active[a] = active[--active_count];
+            }
+            else
+                a++;
+        }
+
+        // the copy's source ends where it starts, so the two can share a register
+        int source = plan.copied_from[current];
+        if (source >= 0 && plan.reg[source] >= 0 && plan.end[source] == plan.start[current])
+        {
+            for (int a = 0; a < active_count; a++)
+                if (active[a] == source)
+                    active[a] = current;
+            plan.reg[current] = plan.reg[source];
+            continue;
+        }
+
+        if (free_set)
+        {
+            plan.reg[current] = __builtin_ctz(free_set);
+            free_set &= free_set - 1;
+            active[active_count++] = current;
+            continue;
+        }
+
+        int victim = pick_spill(&plan, active, active_count, current);
+        if (victim == current)
+            continue;
+        for (int a = 0; a < active_count; a++)
+            if (active[a] == victim)
+                active[a] = current;
+        plan.reg[current] = plan.reg[victim];
+        plan.reg[victim] = -1;
+    }
+
+    // a temporary heading for a resident variable borrows its register
+    for (int id = plan.ids.var_count; id < ids; id++)
+        if (plan.copied_into[id] >= 0 && plan.reg[plan.copied_into[id]] >= 0)
+            plan.reg[id] = plan.reg[plan.copied_into[id]];
+
+    free(order);
+    return plan;
+}
+
+void regalloc_free(RegisterPlan *plan)
+{
+    free(plan->reg);
+    free(plan->start);
+    free(plan->end);
+    free(plan->dirty);
+    free(plan->copied_from);
+    free(plan->copied_into);
+    plan->reg = plan->start = plan->end = plan->copied_from = plan->copied_into = NULL;
+    plan->dirty = NULL;
+}
+
+// === EVALUATION ORDER ===
+typedef struct
+{
+    const TACInstruction *code;
+    const int *child; // per instruction: the two instructions computing its operands in its tree, -1 for leaves
+    const int *need;
+    char *nested;
+    TACInstruction *out;
+    int out_count;
+} TreeOrder;
+
+// writes instruction i's tree to out, the operand needing more registers first
+static void emit_tree(TreeOrder *t, int i)
+{
+    int first = t->child[2 * i], second = t->child[2 * i + 1];
+    if (second >= 0 && (first < 0 || t->need[second] > t->need[first]))
+    {
+        first = second;
+        second = t->child[2 * i];
+    }
+    if (first >= 0)
+        emit_tree(t, first);
+    if (second >= 0)
+        emit_tree(t, second);
+    t->nested[i] = 1;
+    t->out[t->out_count++] = t->code[i];
+}
+
+void regalloc_order_trees(TACInstruction *code, int count)
+{
+    if (count == 0)
+        return;
+
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    int temps = ids.temp_count;
+    int *def_at = malloc(sizeof(int) * (temps + 1));
+    int *uses = calloc(temps + 1, sizeof(int));
+    int *child = malloc(sizeof(int) * 2 * count);
+    int *need = malloc(sizeof(int) * count);
+    int *size = malloc(sizeof(int) * count);
+    int *low = malloc(sizeof(int) * count);
+    char *nested = calloc(count, 1);
+    TACInstruction *out = malloc(sizeof(TACInstruction) * count);
+    if (!def_at || !uses || !child || !need || !size || !low || !nested || !out)
+    {
+        fprintf(stderr, "Memory allocation failed in regalloc_order_trees()\n");
+        exit(1);
+    }
+
+    for (int k = 0; k < temps; k++)
+        def_at[k] = -1;
+    for (int i = 0; i < count; i++)
+    {
+        if (tac_is_temp(code[i].result))
+        {
+            int k = tac_index(code[i].result);
+            def_at[k] = def_at[k] == -1 ? i : -2;
+        }
+        if (tac_is_temp(code[i].arg1))
+            uses[tac_index(code[i].arg1)]++;
+        if (tac_is_temp(code[i].arg2))
+            uses[tac_index(code[i].arg2)]++;
+    }
+
+    /* Labels, bottom up: a temporary read only here, defined once and
+       earlier, is a child. Variables and constants are loaded when their
+       instruction runs, so leaves need no register before then. */
+    for (int i = 0; i < count; i++)
+    {
+        int n[2] = {0, 0};
+        const TACOperand args[2] = {code[i].arg1, code[i].arg2};
+        size[i] = 1;
+        low[i] = i;
+        for (int k = 0; k < 2; k++)
+        {
+            int d = tac_is_temp(args[k]) ? def_at[tac_index(args[k])] : -1;
+            child[2 * i + k] = d >= 0 && d < i && uses[tac_index(args[k])] == 1 ? d : -1;
+            if (child[2 * i + k] < 0)
+                continue;
+            n[k] = need[d];
+            size[i] += size[d];
+            if (low[d] < low[i])
+                low[i] = low[d];
+        }
+        need[i] = n[0] == n[1] ? n[0] + 1 : n[0] > n[1] ? n[0] : n[1];
+    }
+
+    /* A tree is reordered when its instructions are exactly the run
+       ending at its root: then nothing else (a variable written by ++,
+       say) sits between them, and only the root can write a variable. */
+    TreeOrder t = {code, child, need, nested, out, 0};
+    for (int i = count - 1; i >= 0; i--)
+    {
+        if (nested[i] || i - low[i] + 1 != size[i])
+            continue;
+        t.out_count = 0;
+        emit_tree(&t, i);
+        memcpy(&code[low[i]], out, sizeof(TACInstruction) * size[i]);
+    }
+
+    free(def_at);
+    free(uses);
+    free(child);
+    free(need);
+    free(size);
+    free(low);
+    free(nested);
+    free(out);
+}
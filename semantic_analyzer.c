@@ -1,13 +1,23 @@
 #include "headers/semantic_analyzer.h"
 
-static SEM_TEMP *sem_temps = NULL;
-static size_t sem_temps_capacity = 0;
-static size_t sem_temps_count = 0;
 static int sem_next_temp_id = 1;
 
+/* temporaries are plain values; only a per-statement count is kept */
+static size_t sem_stmt_temps = 0;
+static size_t sem_peak_stmt_temps = 0;
+
+/* bytes currently held by the semantic phase and the high-water mark */
+static size_t sem_bytes_in_use = 0;
+static size_t sem_bytes_peak = 0;
+static int sem_known_var_count = 0;
+
 static KnownVar *known_vars_head = NULL;
 static int sem_errors = 0;
 
+/* set per statement: identifiers with known values may be folded into literals
+   only when nothing in the statement changes a variable mid-expression */
+static int sem_fold_vars = 1;
+
 /* ----------------- Forward declarations ----------------- */
 static SEM_TEMP evaluate_expression(ASTNode *node);
 static void analyze_statement_list(ASTNode *stmt_list);
@@ -15,7 +25,7 @@ static void analyze_statement_list(ASTNode *stmt_list);
 /* ----------------- Helpers ----------------- */
 /* Parses a char literal like 'a', '\n', '\\', '\t', etc.
    Returns 1 if valid, with ASCII value in *out. */
-static int try_parse_char_literal(const char *lex, long *out)
+static int try_parse_char_literal(const char *lex, long long *out)
 {
     if (!lex)
         return 0;
@@ -33,7 +43,7 @@ static int try_parse_char_literal(const char *lex, long *out)
     if (content_len == 1)
     {
         unsigned char c = (unsigned char)lex[1];
-        *out = (long)c;
+        *out = (long long)c;
         return 1;
     }
 
@@ -68,7 +78,7 @@ static int try_parse_char_literal(const char *lex, long *out)
         default:
             return 0; // unknown/unsupported escape
         }
-        *out = (long)c;
+        *out = (long long)c;
         return 1;
     }
 
@@ -76,66 +86,40 @@ static int try_parse_char_literal(const char *lex, long *out)
     return 0;
 }
 
-// prints and counts the semantic errors
-static void sem_record_error(ASTNode *node, const char *fmt, ...)
+// records and counts the semantic errors; arg is the message's identifier, if any
+static void sem_record_error(ASTNode *node, DiagCode code, const char *arg)
 {
     sem_errors++;
-    fprintf(stderr, "Semantic Error: ");
-    va_list ap;
-    va_start(ap, fmt);
-    vfprintf(stderr, fmt, ap);
-    va_end(ap);
-    if (node && node->value)
-        fprintf(stderr, " (node: '%s')", node->value);
-
-    fprintf(stderr, "\n");
+    diag_report(code, node ? node->line : 0, node ? node->value : NULL, arg);
 }
 
-// prints semantic warnings
-static void sem_record_warning(ASTNode *node, const char *fmt, ...)
+// accounts bytes taken by the semantic phase so the peak can be reported
+static void sem_account_alloc(size_t bytes)
 {
-    fprintf(stderr, "Semantic Warning: ");
-    va_list ap;
-    va_start(ap, fmt);
-
-    vfprintf(stderr, fmt, ap);
-    va_end(ap);
-
-    if (node && node->value)
-        fprintf(stderr, " (node: '%s')", node->value);
-
-    fprintf(stderr, "\n");
+    sem_bytes_in_use += bytes;
+    if (sem_bytes_in_use > sem_bytes_peak)
+        sem_bytes_peak = sem_bytes_in_use;
 }
 
-// Expands memory buffer for temporary values
-static int ensure_temp_capacity(void)
+static void sem_account_free(size_t bytes)
 {
-    if (sem_temps_count + 1 > sem_temps_capacity)
-    {
-        size_t newcap = sem_temps_capacity == 0 ? 256 : sem_temps_capacity * 2;
-        SEM_TEMP *newbuf = realloc(sem_temps, newcap * sizeof(SEM_TEMP));
-        if (!newbuf)
-        {
-            fprintf(stderr, "Out of memory allocating semantic temps\n");
-            return 0;
-        }
-        sem_temps = newbuf;
-        sem_temps_capacity = newcap;
-    }
-    return 1;
+    sem_bytes_in_use -= bytes;
 }
 
-// creates and stores a new SEM_TEMP instance.
-static SEM_TEMP make_temp(SEM_TYPE type, int is_const, long val, ASTNode *node)
+// creates a new SEM_TEMP value. Callers keep the returned copy, so nothing is
+// stored; only the per-statement count is tracked for the memory report.
+static SEM_TEMP make_temp(SEM_TYPE type, int is_const, long long val, ASTNode *node)
 {
-    ensure_temp_capacity();
+    if (++sem_stmt_temps > sem_peak_stmt_temps)
+        sem_peak_stmt_temps = sem_stmt_temps;
+
     SEM_TEMP t;
     t.id = sem_next_temp_id++;
     t.type = type;
     t.is_constant = is_const;
+    t.has_side_effects = 0;
     t.int_value = val;
     t.node = node;
-    sem_temps[sem_temps_count++] = t;
     return t;
 }
 
@@ -159,7 +143,6 @@ static void set_known_var(const char *name, SEM_TEMP t, int initialized)
     {
         k->temp = t;
         k->initialized = initialized;
-        /* do not reset 'used' because prior uses are still relevant */
         return;
     }
 
@@ -171,9 +154,16 @@ static void set_known_var(const char *name, SEM_TEMP t, int initialized)
     }
 
     k->name = strdup(name);
+    if (!k->name)
+    {
+        fprintf(stderr, "Out of memory in set_known_var\n");
+        exit(1);
+    }
+    sem_account_alloc(sizeof(KnownVar) + strlen(name) + 1);
+    sem_known_var_count++;
+
     k->temp = t;
     k->initialized = initialized;
-    k->used = 0;
     k->next = known_vars_head;
     known_vars_head = k;
 }
@@ -188,6 +178,8 @@ static void remove_known_var(const char *name)
         {
             KnownVar *rem = *pp;
             *pp = rem->next;
+            sem_account_free(sizeof(KnownVar) + strlen(rem->name) + 1);
+            sem_known_var_count--;
             free(rem->name);
             free(rem);
             return;
@@ -196,12 +188,18 @@ static void remove_known_var(const char *name)
     }
 }
 
-/* mark variable as used (for warnings) */
-static void mark_known_var_used(const char *name)
+// release every known variable once the analysis is over
+static void free_known_vars(void)
 {
-    KnownVar *k = find_known_var(name);
-    if (k)
-        k->used = 1;
+    while (known_vars_head)
+    {
+        KnownVar *next = known_vars_head->next;
+        sem_account_free(sizeof(KnownVar) + strlen(known_vars_head->name) + 1);
+        free(known_vars_head->name);
+        free(known_vars_head);
+        known_vars_head = next;
+    }
+    sem_known_var_count = 0;
 }
 
 /* convert symbol_table datatype to SEM_TYPE
@@ -215,20 +213,20 @@ static SEM_TYPE datatype_to_semtype(const char *dt)
 {
     if (!dt)
         return SEM_TYPE_UNKNOWN;
-    if (strcmp(dt, "int") == 0)
+    if (strcmp(dt, "int") == 0 || strcmp(dt, "ENTEGER") == 0)
         return SEM_TYPE_INT;
-    if (strcmp(dt, "char") == 0)
+    if (strcmp(dt, "char") == 0 || strcmp(dt, "CHAROT") == 0)
         return SEM_TYPE_CHAR;
     return SEM_TYPE_UNKNOWN;
 }
 
 /* try parse int literal string; returns 1 if succeeded */
-static int try_parse_int(const char *s, long *out)
+static int try_parse_int(const char *s, long long *out)
 {
     if (!s)
         return 0;
     char *end;
-    long v = strtol(s, &end, 10);
+    long long v = strtoll(s, &end, 10);
     if (end != s && *end == '\0')
     {
         *out = v;
@@ -237,6 +235,113 @@ static int try_parse_int(const char *s, long *out)
     return 0;
 }
 
+/* applies a binary operator with 64-bit two's complement wraparound, the same
+   results the MIPS64 daddu/dsub/dmult/ddiv sequence produces.
+   returns 0 when the operation cannot be folded (division by zero) */
+static int fold_binary(const char *op, long long L, long long R, long long *out)
+{
+    unsigned long long ul = (unsigned long long)L, ur = (unsigned long long)R;
+
+    if (strcmp(op, "+") == 0)
+        *out = (long long)(ul + ur);
+    else if (strcmp(op, "-") == 0)
+        *out = (long long)(ul - ur);
+    else if (strcmp(op, "*") == 0)
+        *out = (long long)(ul * ur);
+    else if (strcmp(op, "/") == 0)
+    {
+        if (R == 0)
+            return 0;
+        if (R == -1)
+            *out = (long long)(0ULL - ul); // avoids LLONG_MIN / -1 overflow
+        else
+            *out = L / R;
+    }
+    else
+        return 0;
+
+    return 1;
+}
+
+/* returns 1 if the subtree assigns to or increments a variable */
+static int has_side_effects(ASTNode *node)
+{
+    if (!node)
+        return 0;
+    if (node->type == NODE_ASSIGNMENT || node->type == NODE_POSTFIX_OP)
+        return 1;
+    if (node->type == NODE_UNARY_OP && node->value &&
+        (strcmp(node->value, "++") == 0 || strcmp(node->value, "--") == 0))
+        return 1;
+    return has_side_effects(node->left) || has_side_effects(node->right);
+}
+
+/* returns 1 if the statement changes a variable before its final value is
+   computed, e.g. a = b++ + b or c = (a = 2) * a. A plain assignment chain
+   (a = b = expr) only writes after expr is evaluated, so it does not count. */
+static int has_inner_side_effects(ASTNode *stmt)
+{
+    while (stmt && stmt->type == NODE_ASSIGNMENT)
+        stmt = stmt->right;
+    return has_side_effects(stmt);
+}
+
+/* returns 1 if every leaf of the subtree is an integer or char literal */
+static int is_literal_tree(ASTNode *node)
+{
+    if (!node)
+        return 1;
+    if (node->type == NODE_FACTOR)
+    {
+        long long v;
+        return try_parse_int(node->value, &v) || try_parse_char_literal(node->value, &v);
+    }
+    return is_literal_tree(node->left) && is_literal_tree(node->right);
+}
+
+/* Rewrites a subtree the analysis proved constant into an integer literal
+   leaf, so intermediate code generation emits no arithmetic for it.
+   Subtrees with side effects are kept, and identifiers are only replaced
+   when the statement reads every variable before changing any. */
+static SEM_TEMP fold_node(ASTNode *node, SEM_TEMP t)
+{
+    if (!node || !t.is_constant || t.has_side_effects)
+        return t;
+
+    if (node->type == NODE_FACTOR)
+    {
+        long long v;
+        if (!node->value || try_parse_int(node->value, &v))
+            return t; // already an integer literal
+
+        int is_identifier = isalpha((unsigned char)node->value[0]) || node->value[0] == '_';
+        if (is_identifier && !sem_fold_vars)
+            return t;
+    }
+    else if (!sem_fold_vars && (node->left || node->right))
+    {
+        /* fold only subtrees built from literals */
+        if (!is_literal_tree(node))
+            return t;
+    }
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%lld", t.int_value);
+    char *lit = strdup(buf);
+    if (!lit)
+        return t;
+
+    free_ast(node->left);
+    free_ast(node->right);
+    free(node->value);
+    node->type = NODE_FACTOR;
+    node->value = lit;
+    node->left = NULL;
+    node->right = NULL;
+
+    return t;
+}
+
 /* ----------------- Try evaluate subtree as constant -----------------
    Returns 1 if the subtree is compile-time-evaluable to an integer, with value in *out.
    Uses:
@@ -247,7 +352,7 @@ static int try_parse_int(const char *s, long *out)
      - recursively evaluates +, -, *, / when operands are constant
    Conservative: returns 0 if any part is unknown or division by zero would occur.
    --------------------------------------------------------------- */
-static int try_eval_constant(ASTNode *node, long *out)
+static int try_eval_constant(ASTNode *node, long long *out)
 {
     if (!node)
         return 0;
@@ -258,14 +363,14 @@ static int try_eval_constant(ASTNode *node, long *out)
         if (!lex)
             return 0;
 
-        long v;
+        long long v;
         if (try_parse_int(lex, &v))
         {
             *out = v;
             return 1;
         }
 
-        long cv;
+        long long cv;
         if (try_parse_char_literal(lex, &cv))
         {
             *out = cv;
@@ -288,7 +393,7 @@ static int try_eval_constant(ASTNode *node, long *out)
             int idx = find_symbol(lex);
             if (idx != -1 && symbol_table[idx].initialized && symbol_table[idx].value_str[0] != '\0')
             {
-                long vv;
+                long long vv;
                 if (try_parse_int(symbol_table[idx].value_str, &vv))
                 {
                     *out = vv;
@@ -302,7 +407,7 @@ static int try_eval_constant(ASTNode *node, long *out)
 
     if (node->type == NODE_TERM)
     {
-        long L, R;
+        long long L, R;
         if (!try_eval_constant(node->left, &L))
             return 0;
         if (!try_eval_constant(node->right, &R))
@@ -325,7 +430,7 @@ static int try_eval_constant(ASTNode *node, long *out)
 
     if (node->type == NODE_EXPRESSION)
     {
-        long L, R;
+        long long L, R;
         if (!try_eval_constant(node->left, &L))
             return 0;
         if (!try_eval_constant(node->right, &R))
@@ -346,7 +451,7 @@ static int try_eval_constant(ASTNode *node, long *out)
 
     if (node->type == NODE_UNARY_OP)
     {
-        long v;
+        long long v;
         if (!try_eval_constant(node->left, &v))
             return 0;
         const char *op = node->value ? node->value : "";
@@ -380,14 +485,14 @@ static SEM_TEMP eval_factor(ASTNode *node)
         if (!lex)
             return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
 
-        long v;
+        long long v;
         if (try_parse_int(lex, &v))
             return make_temp(SEM_TYPE_INT, 1, v, node);
 
-        long cv;
+        long long cv;
         if (try_parse_char_literal(lex, &cv))
         {
-            return make_temp(SEM_TYPE_CHAR, 1, cv, node);
+            return fold_node(node, make_temp(SEM_TYPE_CHAR, 1, cv, node));
         }
 
         if (isalpha((unsigned char)lex[0]) || lex[0] == '_')
@@ -396,47 +501,32 @@ static SEM_TEMP eval_factor(ASTNode *node)
             KnownVar *k = find_known_var(lex);
             if (k)
             {
-                /* mark used for later "declared but never used" detection */
-                k->used = 1;
-
-                /* If variable is not initialized, warn (but do not error) */
-                if (!k->initialized)
-                {
-                    sem_record_warning(node, "Use of uninitialized variable '%s'", lex);
-                }
-
+                /* reads before assignment are reported from the TAC by the
+                   definite-assignment analysis */
                 SEM_TEMP tv = k->temp;
                 tv.node = node;
-                return tv;
+                return fold_node(node, tv);
             }
 
             /* fallback to symbol table */
             int idx = find_symbol(lex);
             if (idx == -1)
             {
-                sem_record_error(node, "Undeclared identifier '%s'", lex);
+                sem_record_error(node, DIAG_SEM_UNDECLARED, lex);
                 return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
             }
 
-            /* mark usage for later warnings: create or update known var placeholder so we can track used status */
+            /* create or update the known var placeholder */
             SEM_TEMP placeholder = make_temp(datatype_to_semtype(symbol_table[idx].datatype), 0, 0, node);
             set_known_var(lex, placeholder, symbol_table[idx].initialized);
-            KnownVar *newk = find_known_var(lex);
-            if (newk)
-                newk->used = 1;
 
-            /* If symbol_table says not initialized, warn (but don't error) */
-            if (!symbol_table[idx].initialized)
-            {
-                sem_record_warning(node, "Use of uninitialized variable '%s'", lex);
-            }
-            else
+            if (symbol_table[idx].initialized)
             {
                 /* if symbol table has a parseable initializer, return constant temp */
-                long vv;
+                long long vv;
                 if (symbol_table[idx].value_str[0] != '\0' && try_parse_int(symbol_table[idx].value_str, &vv))
                 {
-                    return make_temp(datatype_to_semtype(symbol_table[idx].datatype), 1, vv, node);
+                    return fold_node(node, make_temp(datatype_to_semtype(symbol_table[idx].datatype), 1, vv, node));
                 }
             }
 
@@ -461,46 +551,37 @@ static SEM_TEMP eval_term(ASTNode *node)
     SEM_TEMP L = eval_term(node->left);
     SEM_TEMP R = eval_factor(node->right);
     const char *op = node->value ? node->value : "";
+    int side_effects = L.has_side_effects || R.has_side_effects;
 
     if (strcmp(op, "/") == 0)
     {
         /* if right is constant and zero -> error */
         if (R.is_constant && R.int_value == 0)
         {
-            sem_record_error(node, "Division by zero detected at compile time");
+            sem_record_error(node, DIAG_SEM_DIVISION_BY_ZERO, NULL);
             return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
         }
 
         /* else, attempt to resolve subtree to constant and check */
-        long denom;
+        long long denom;
         if (try_eval_constant(node->right, &denom))
         {
             if (denom == 0)
             {
-                sem_record_error(node, "Division by zero detected at compile time");
+                sem_record_error(node, DIAG_SEM_DIVISION_BY_ZERO, NULL);
                 return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
             }
         }
     }
 
     /* constant folding */
-    if (L.is_constant && R.is_constant)
-    {
-        if (strcmp(op, "*") == 0)
-        {
-            long val = L.int_value * R.int_value;
-            return make_temp(SEM_TYPE_INT, 1, val, node);
-        }
-        else if (strcmp(op, "/") == 0)
-        {
-            if (R.int_value == 0)
-                return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
-            long val = L.int_value / R.int_value;
-            return make_temp(SEM_TYPE_INT, 1, val, node);
-        }
-    }
+    long long val;
+    if (L.is_constant && R.is_constant && !side_effects && fold_binary(op, L.int_value, R.int_value, &val))
+        return fold_node(node, make_temp(SEM_TYPE_INT, 1, val, node));
 
-    return make_temp(SEM_TYPE_INT, 0, 0, node);
+    SEM_TEMP t = make_temp(SEM_TYPE_INT, 0, 0, node);
+    t.has_side_effects = side_effects;
+    return t;
 }
 
 /* evaluate additive / expression nodes (handles + and -) */
@@ -514,22 +595,61 @@ static SEM_TEMP eval_additive(ASTNode *node)
     SEM_TEMP L = eval_additive(node->left);
     SEM_TEMP R = eval_term(node->right);
     const char *op = node->value ? node->value : "";
+    int side_effects = L.has_side_effects || R.has_side_effects;
 
-    if (L.is_constant && R.is_constant)
+    long long val;
+    if (L.is_constant && R.is_constant && !side_effects && fold_binary(op, L.int_value, R.int_value, &val))
+        return fold_node(node, make_temp(SEM_TYPE_INT, 1, val, node));
+
+    SEM_TEMP t = make_temp(SEM_TYPE_INT, 0, 0, node);
+    t.has_side_effects = side_effects;
+    return t;
+}
+
+/* evaluate prefix/postfix ++ and -- : the variable's known value moves by one,
+   the expression itself is never folded because it changes the variable */
+static SEM_TEMP eval_increment(ASTNode *node)
+{
+    ASTNode *operand = node->left;
+    const char *name = operand && operand->type == NODE_FACTOR ? operand->value : NULL;
+
+    if (name && (isalpha((unsigned char)name[0]) || name[0] == '_'))
     {
-        if (strcmp(op, "+") == 0)
+        KnownVar *k = find_known_var(name);
+        if (!k)
         {
-            long val = L.int_value + R.int_value;
-            return make_temp(SEM_TYPE_INT, 1, val, node);
+            int idx = find_symbol(name);
+            if (idx == -1)
+            {
+                sem_record_error(node, DIAG_SEM_UNDECLARED, name);
+                return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
+            }
+            set_known_var(name, make_temp(datatype_to_semtype(symbol_table[idx].datatype), 0, 0, operand),
+                          symbol_table[idx].initialized);
+            k = find_known_var(name);
         }
-        else if (strcmp(op, "-") == 0)
+
+        if (k->initialized && k->temp.is_constant)
         {
-            long val = L.int_value - R.int_value;
-            return make_temp(SEM_TYPE_INT, 1, val, node);
+            long long val;
+            fold_binary(node->value[0] == '+' ? "+" : "-", k->temp.int_value, 1, &val);
+            k->temp = make_temp(k->temp.type, 1, val, operand);
+
+            int idx = find_symbol(name);
+            if (idx != -1)
+                snprintf(symbol_table[idx].value_str, sizeof(symbol_table[idx].value_str), "%lld", val);
         }
+        else
+            k->temp.is_constant = 0;
+    }
+    else if (operand)
+    {
+        evaluate_expression(operand);
     }
 
-    return make_temp(SEM_TYPE_INT, 0, 0, node);
+    SEM_TEMP t = make_temp(SEM_TYPE_INT, 0, 0, node);
+    t.has_side_effects = 1;
+    return t;
 }
 
 /* evaluate assignment nodes */
@@ -542,13 +662,13 @@ static SEM_TEMP eval_assignment(ASTNode *node)
     ASTNode *rhs = node->right;
     if (!lhs || lhs->type != NODE_FACTOR)
     {
-        sem_record_error(node, "Invalid assignment LHS");
+        sem_record_error(node, DIAG_SEM_INVALID_LHS, NULL);
         return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
     }
     const char *varname = lhs->value;
     if (!varname)
     {
-        sem_record_error(node, "Invalid identifier on LHS");
+        sem_record_error(node, DIAG_SEM_INVALID_IDENTIFIER, NULL);
         return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
     }
 
@@ -561,31 +681,52 @@ static SEM_TEMP eval_assignment(ASTNode *node)
     int idx = find_symbol(varname);
     if (idx == -1)
     {
-        sem_record_error(node, "Assignment to undeclared variable '%s'", varname);
+        sem_record_error(node, DIAG_SEM_ASSIGN_UNDECLARED, varname);
         return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
     }
 
-    if (rhs_temp.is_constant)
+    int is_const = rhs_temp.is_constant;
+    long long value = rhs_temp.int_value;
+    int initialized = 1;
+
+    /* compound assignment (+=, -=, *=, /=) reads the variable first: x op= e is x = x op e */
+    const char *op = node->value ? node->value : "=";
+    if (strcmp(op, "=") != 0)
     {
-        SEM_TEMP store_temp = make_temp(datatype_to_semtype(symbol_table[idx].datatype), 1, rhs_temp.int_value, node);
-        set_known_var(varname, store_temp, 1);
+        char bin_op[2] = {op[0], '\0'};
+        KnownVar *k = find_known_var(varname);
+        initialized = k ? k->initialized : symbol_table[idx].initialized;
 
-        /* Propagate constant value into symbol table so later passes (TAC/ASM) see numeric value */
-        if (symbol_table[idx].value_str)
+        if (bin_op[0] == '/' && is_const && value == 0)
         {
-            snprintf(symbol_table[idx].value_str, sizeof(symbol_table[idx].value_str), "%ld", rhs_temp.int_value);
-            symbol_table[idx].initialized = 1;
+            sem_record_error(node, DIAG_SEM_DIVISION_BY_ZERO, NULL);
+            return make_temp(SEM_TYPE_UNKNOWN, 0, 0, node);
         }
+
+        is_const = is_const && k && k->initialized && k->temp.is_constant &&
+                   fold_binary(bin_op, k->temp.int_value, value, &value);
+    }
+
+    if (is_const)
+    {
+        SEM_TEMP store_temp = make_temp(datatype_to_semtype(symbol_table[idx].datatype), 1, value, node);
+        set_known_var(varname, store_temp, 1);
+
+        /* Propagate constant value into symbol table so later passes (TAC/ASM) see numeric value */
+        snprintf(symbol_table[idx].value_str, sizeof(symbol_table[idx].value_str), "%lld", value);
+        symbol_table[idx].initialized = 1;
     }
     else
     {
-        /* We don't know the value at compile-time; mark as declared but not semantically-initialized */
+        /* We don't know the value at compile-time; a plain assignment marks it as declared but not
+           semantically-initialized, a compound one keeps whatever state it had */
         SEM_TEMP placeholder = make_temp(datatype_to_semtype(symbol_table[idx].datatype), 0, 0, node);
-        set_known_var(varname, placeholder, 0);
-        /* remove_known_var(varname);  // we keep placeholder so we can warn about unused later */
+        set_known_var(varname, placeholder, strcmp(op, "=") != 0 && initialized);
     }
 
-    return make_temp(datatype_to_semtype(symbol_table[idx].datatype), rhs_temp.is_constant, rhs_temp.int_value, node);
+    SEM_TEMP t = make_temp(datatype_to_semtype(symbol_table[idx].datatype), is_const, value, node);
+    t.has_side_effects = 1;
+    return t;
 }
 
 // calls the appropriate evaluation function based on AST node type.
@@ -614,19 +755,29 @@ static SEM_TEMP evaluate_expression(ASTNode *node)
         return eval_factor(node);
     case NODE_UNARY_OP:
     {
+        if (strcmp(node->value, "++") == 0 || strcmp(node->value, "--") == 0)
+            return eval_increment(node);
+
         SEM_TEMP t = evaluate_expression(node->left);
 
-        if (t.is_constant)
+        if (t.is_constant && !t.has_side_effects)
         {
             if (strcmp(node->value, "+") == 0)
-                return t;
+                return fold_node(node, t);
             if (strcmp(node->value, "-") == 0)
-                return make_temp(t.type, 1, -t.int_value, node);
+            {
+                long long val;
+                fold_binary("-", 0, t.int_value, &val);
+                return fold_node(node, make_temp(t.type, 1, val, node));
+            }
         }
-        return make_temp(t.type, 0, 0, node);
+
+        SEM_TEMP r = make_temp(t.type, 0, 0, node);
+        r.has_side_effects = t.has_side_effects;
+        return r;
     }
     case NODE_POSTFIX_OP:
-        return make_temp(SEM_TYPE_INT, 0, 0, node);
+        return eval_increment(node);
     default:
         if (node->left)
             evaluate_expression(node->left);
@@ -636,17 +787,21 @@ static SEM_TEMP evaluate_expression(ASTNode *node)
     }
 }
 
-// Walk through the AST, find statements, handle declarations, evaluate expressions, and warn about unused variables.
+// Walk through the AST, find statements, handle declarations, and evaluate expressions.
 static void analyze_statement_list(ASTNode *stmt_list)
 {
     // Go through each statement node in the list. Each node’s right pointer links to the next statement.
     for (ASTNode *cur = stmt_list; cur; cur = cur->right)
     {
-        if (!cur)
+        // stop early once the error cap is reached
+        if (!cur || diag_should_abort())
             break;
 
         if (cur->type == NODE_STATEMENT_LIST)
         {
+            // temporaries never outlive their statement
+            sem_stmt_temps = 0;
+
             ASTNode *stmt_wrapper = cur->left;
 
             if (!stmt_wrapper)
@@ -674,6 +829,7 @@ static void analyze_statement_list(ASTNode *stmt_list)
                         // example: int a = 1;
                         if (initializer)
                         {
+                            sem_fold_vars = !has_inner_side_effects(initializer);
                             SEM_TEMP val = evaluate_expression(initializer);
 
                             if (val.is_constant)
@@ -687,7 +843,7 @@ static void analyze_statement_list(ASTNode *stmt_list)
                                 if (sidx != -1 && symbol_table[sidx].value_str)
                                 {
                                     // write to symbol table (value_str) with its ascii value
-                                    snprintf(symbol_table[sidx].value_str, sizeof(symbol_table[sidx].value_str), "%ld", val.int_value);
+                                    snprintf(symbol_table[sidx].value_str, sizeof(symbol_table[sidx].value_str), "%lld", val.int_value);
                                     symbol_table[sidx].initialized = 1;
                                 }
                             }
@@ -713,37 +869,12 @@ static void analyze_statement_list(ASTNode *stmt_list)
                 // otherwise, it is an expression
                 else
                 {
+                    sem_fold_vars = !has_inner_side_effects(stmt);
                     evaluate_expression(stmt);
                 }
             }
         }
     }
-
-    // After that, produce warnings for declared-but-never-initialized-or-used variables
-    // iterate to symbol table
-    for (int i = 0; i < symbol_count; ++i)
-    {
-        const char *name = symbol_table[i].name;
-        int sym_init = symbol_table[i].initialized;
-
-        KnownVar *k = find_known_var(name);
-        if (!k)
-        {
-            /* if symbol declared and not initialized in symbol table, warn */
-            if (!sym_init)
-            {
-                sem_record_warning(NULL, "Variable '%s' declared but never initialized or used", name);
-            }
-            continue;
-        }
-
-        if (!sym_init)
-        {
-            // if we have known-var placeholder and it was never used and not initialized semantically
-            if (!k->initialized && !k->used)
-                sem_record_warning(k->temp.node, "Variable '%s' declared but never initialized or used", name);
-        }
-    }
 }
 
 // main driver function
@@ -760,6 +891,10 @@ int semantic_analyzer(void)
     if (!stmts)
         return 0;
 
+    sem_stmt_temps = 0;
+    sem_peak_stmt_temps = 0;
+    sem_bytes_peak = sem_bytes_in_use;
+
     analyze_statement_list(stmts);
 
     if (sem_errors == 0)
@@ -767,7 +902,34 @@ int semantic_analyzer(void)
     else
         printf("Semantic Analysis: %d error(s) detected.\n", sem_errors);
 
+    printf("Semantic Analysis: peak memory %zu bytes (%d known variable(s), at most %zu temporaries per statement).\n",
+           sem_bytes_peak, sem_known_var_count, sem_peak_stmt_temps);
+
+    // known variables are only needed during the analysis itself
+    free_known_vars();
+
     return sem_errors;
 }
 
+/* Streaming use: checks one tree's statements against everything seen
+   so far, printing nothing. Known values carry over to the next call
+   until semantic_finish(). Returns the errors found so far in total. */
+int semantic_analyze(ASTNode *tree)
+{
+    if (tree && tree->left)
+        analyze_statement_list(tree->left);
+
+    // the caller frees this tree before the next chunk arrives
+    for (KnownVar *k = known_vars_head; k; k = k->next)
+        k->temp.node = NULL;
+    return sem_errors;
+}
+
+void semantic_finish(void)
+{
+    free_known_vars();
+}
+
+size_t semantic_peak_memory(void) { return sem_bytes_peak; }
+
 int semantic_error_count(void) { return sem_errors; }
\ No newline at end of file
@@ -0,0 +1,361 @@
+// ssa.c
+#include "headers/ssa.h"
+
+static void *ssa_alloc(size_t size)
+{
+    void *p = calloc(1, size > 0 ? size : 1);
+    if (!p)
+    {
+        fprintf(stderr, "Memory allocation failed in ssa\n");
+        exit(1);
+    }
+    return p;
+}
+
+// === CONSTRUCTION ===
+static int new_value(SSAForm *ssa, int *next_version, int id, int def)
+{
+    int v = ssa->value_count++;
+    ssa->values[v].id = id;
+    ssa->values[v].version = next_version[id]++;
+    ssa->values[v].def = def;
+    return v;
+}
+
+static void build_def_use(SSAForm *ssa)
+{
+    int *counts = ssa_alloc(sizeof(int) * (ssa->value_count + 1));
+
+    for (int i = 0; i < ssa->count; i++)
+        for (int k = 0; k < 2; k++)
+            if (ssa->use_value[i][k] >= 0)
+                counts[ssa->use_value[i][k]]++;
+    for (int p = 0; p < ssa->phi_count; p++)
+        for (int a = 0; a < ssa->phis[p].arg_count; a++)
+            counts[ssa->phis[p].args[a]]++;
+
+    ssa->user_start = ssa_alloc(sizeof(int) * (ssa->value_count + 1));
+    for (int v = 0; v < ssa->value_count; v++)
+        ssa->user_start[v + 1] = ssa->user_start[v] + counts[v];
+
+    ssa->users = ssa_alloc(sizeof(int) * ssa->user_start[ssa->value_count]);
+    memcpy(counts, ssa->user_start, sizeof(int) * ssa->value_count);
+    for (int i = 0; i < ssa->count; i++)
+        for (int k = 0; k < 2; k++)
+            if (ssa->use_value[i][k] >= 0)
+                ssa->users[counts[ssa->use_value[i][k]]++] = i;
+    for (int p = 0; p < ssa->phi_count; p++)
+        for (int a = 0; a < ssa->phis[p].arg_count; a++)
+            ssa->users[counts[ssa->phis[p].args[a]]++] = -1 - p;
+
+    free(counts);
+}
+
+/* Renames every definition and use. With a single block the walk below is
+   the whole dominator-tree walk; once TAC has branches, phis are placed at
+   the join blocks and this becomes a walk over the dominator tree. */
+SSAForm ssa_build(const TACInstruction *code, int count)
+{
+    SSAForm ssa;
+    memset(&ssa, 0, sizeof(ssa));
+    ssa.ids = dataflow_id_space(code, count);
+    ssa.count = count;
+
+    int nids = dataflow_id_count(&ssa.ids);
+    ssa.values = ssa_alloc(sizeof(SSAValue) * (count + nids));
+    ssa.def_value = ssa_alloc(sizeof(int) * count);
+    ssa.use_value = ssa_alloc(sizeof(int[2]) * count);
+
+    ssa.block_count = 1;
+    ssa.blocks = ssa_alloc(sizeof(SSABlock));
+    ssa.blocks[0].start = 0;
+    ssa.blocks[0].end = count;
+
+    int *current = ssa_alloc(sizeof(int) * nids);
+    int *next_version = ssa_alloc(sizeof(int) * nids);
+    for (int id = 0; id < nids; id++)
+        current[id] = new_value(&ssa, next_version, id, SSA_ENTRY_DEF);
+
+    for (int b = 0; b < ssa.block_count; b++)
+    {
+        for (int p = ssa.blocks[b].first_phi; p < ssa.blocks[b].first_phi + ssa.blocks[b].phi_count; p++)
+            current[ssa.phis[p].id] = ssa.phis[p].value;
+
+        for (int i = ssa.blocks[b].start; i < ssa.blocks[b].end; i++)
+        {
+            // operands are read before the result is written
+            int a = dataflow_operand_id(&ssa.ids, code[i].arg1);
+            int c = dataflow_operand_id(&ssa.ids, code[i].arg2);
+            ssa.use_value[i][0] = a >= 0 ? current[a] : -1;
+            ssa.use_value[i][1] = c >= 0 ? current[c] : -1;
+
+            int def = dataflow_def_id(&ssa.ids, &code[i]);
+            ssa.def_value[i] = def >= 0 ? (current[def] = new_value(&ssa, next_version, def, i)) : -1;
+        }
+    }
+
+    free(current);
+    free(next_version);
+
+    build_def_use(&ssa);
+    return ssa;
+}
+
+void ssa_free(SSAForm *ssa)
+{
+    for (int p = 0; p < ssa->phi_count; p++)
+        free(ssa->phis[p].args);
+    free(ssa->phis);
+    free(ssa->blocks);
+    free(ssa->values);
+    free(ssa->def_value);
+    free(ssa->use_value);
+    free(ssa->user_start);
+    free(ssa->users);
+    memset(ssa, 0, sizeof(*ssa));
+}
+
+// === SPARSE CONDITIONAL CONSTANT PROPAGATION ===
+typedef enum
+{
+    LATTICE_TOP,    // no evidence yet
+    LATTICE_CONST,  // always this value
+    LATTICE_BOTTOM  // varies
+} LatticeState;
+
+typedef struct
+{
+    LatticeState state;
+    long long value;
+} Lattice;
+
+static Lattice operand_lattice(const Lattice *lat, TACOperand operand, int value)
+{
+    Lattice l = {LATTICE_CONST, 0};
+    if (tac_is_const(operand))
+        l.value = tac_const_value(operand);
+    else if (value >= 0)
+        l = lat[value];
+    else
+        l.state = LATTICE_BOTTOM;
+    return l;
+}
+
+int tac_fold(TACOpcode op, long long a, long long b, long long *out)
+{
+    unsigned long long ua = (unsigned long long)a, ub = (unsigned long long)b;
+    switch (op)
+    {
+    case TAC_COPY:
+        *out = a;
+        return 1;
+    case TAC_ADD:
+        *out = (long long)(ua + ub);
+        return 1;
+    case TAC_SUB:
+        *out = (long long)(ua - ub);
+        return 1;
+    case TAC_MUL:
+        *out = (long long)(ua * ub);
+        return 1;
+    case TAC_DIV:
+        // leave the trapping and overflowing cases to run time
+        if (b == 0 || (b == -1 && a == (long long)(1ULL << 63)))
+            return 0;
+        *out = a / b;
+        return 1;
+    case TAC_SHL:
+    case TAC_SAR:
+    case TAC_SHR:
+        if (b < 0 || b > 63)
+            return 0;
+        *out = op == TAC_SHL ? (long long)(ua << b) : op == TAC_SAR ? a >> b : (long long)(ua >> b);
+        return 1;
+    case TAC_MULHI:
+        *out = (long long)(((__int128)a * b) >> 64);
+        return 1;
+    }
+    return 0;
+}
+
+static Lattice evaluate(const TACInstruction *ins, Lattice a, Lattice b)
+{
+    Lattice r = {LATTICE_BOTTOM, 0};
+
+    if (ins->op == TAC_COPY)
+        return a;
+
+    // x * 0 is 0 whatever x turns out to be
+    if (ins->op == TAC_MUL && ((a.state == LATTICE_CONST && a.value == 0) || (b.state == LATTICE_CONST && b.value == 0)))
+    {
+        r.state = LATTICE_CONST;
+        return r;
+    }
+
+    if (a.state == LATTICE_BOTTOM || b.state == LATTICE_BOTTOM)
+        return r;
+    if (a.state == LATTICE_TOP || b.state == LATTICE_TOP)
+    {
+        r.state = LATTICE_TOP;
+        return r;
+    }
+    if (tac_fold(ins->op, a.value, b.value, &r.value))
+        r.state = LATTICE_CONST;
+    return r;
+}
+
+static Lattice meet(Lattice a, Lattice b)
+{
+    if (a.state == LATTICE_TOP)
+        return b;
+    if (b.state == LATTICE_TOP)
+        return a;
+    if (a.state == LATTICE_CONST && b.state == LATTICE_CONST && a.value == b.value)
+        return a;
+    Lattice bottom = {LATTICE_BOTTOM, 0};
+    return bottom;
+}
+
+// lowers lat[v] to l; returns 1 if it changed
+static int lower(Lattice *lat, int v, Lattice l)
+{
+    if (lat[v].state == l.state && (l.state != LATTICE_CONST || lat[v].value == l.value))
+        return 0;
+    lat[v] = l;
+    return 1;
+}
+
+static void propagate(const SSAForm *ssa, const TACInstruction *code, Lattice *lat)
+{
+    // worklist of users: instruction index, or -1 - phi index
+    int capacity = ssa->count + ssa->phi_count + 1;
+    int *worklist = ssa_alloc(sizeof(int) * capacity);
+    char *queued = ssa_alloc(ssa->count + ssa->phi_count + 1);
+    int head = 0, size = 0;
+
+    // every block is executable while TAC has no branches
+    for (int i = 0; i < ssa->count; i++)
+    {
+        worklist[size++] = i;
+        queued[i] = 1;
+    }
+
+    while (size > 0)
+    {
+        int item = worklist[head];
+        head = (head + 1) % capacity;
+        size--;
+
+        int value;
+        Lattice l;
+        if (item >= 0)
+        {
+            queued[item] = 0;
+            value = ssa->def_value[item];
+            if (value < 0)
+                continue;
+            const TACInstruction *ins = &code[item];
+            l = evaluate(ins, operand_lattice(lat, ins->arg1, ssa->use_value[item][0]),
+                         operand_lattice(lat, ins->arg2, ssa->use_value[item][1]));
+        }
+        else
+        {
+            const SSAPhi *phi = &ssa->phis[-1 - item];
+            queued[ssa->count - 1 - item] = 0;
+            value = phi->value;
+            l.state = LATTICE_TOP;
+            l.value = 0;
+            for (int a = 0; a < phi->arg_count; a++)
+                l = meet(l, lat[phi->args[a]]);
+        }
+
+        if (!lower(lat, value, l))
+            continue;
+
+        for (int u = ssa->user_start[value]; u < ssa->user_start[value + 1]; u++)
+        {
+            int user = ssa->users[u];
+            int slot = user >= 0 ? user : ssa->count - 1 - user;
+            if (!queued[slot])
+            {
+                queued[slot] = 1;
+                worklist[(head + size) % capacity] = user;
+                size++;
+            }
+        }
+    }
+
+    free(worklist);
+    free(queued);
+}
+
+static int entry_values_zero = 1;
+
+void sccp_set_entry_values_zero(int zero)
+{
+    entry_values_zero = zero;
+}
+
+int sccp_optimize(TACInstruction *code, int *count)
+{
+    int n = *count;
+    if (n == 0)
+        return 0;
+
+    SSAForm ssa = ssa_build(code, n);
+    Lattice *lat = ssa_alloc(sizeof(Lattice) * ssa.value_count);
+
+    // variables start as the zeroes in .data; temporaries are never read unset
+    for (int v = 0; v < ssa.value_count; v++)
+    {
+        if (ssa.values[v].def != SSA_ENTRY_DEF)
+            continue;
+        lat[v].state = entry_values_zero && ssa.values[v].id < ssa.ids.var_count ? LATTICE_CONST : LATTICE_BOTTOM;
+        lat[v].value = 0;
+    }
+
+    propagate(&ssa, code, lat);
+
+    int folded = 0;
+    int j = 0;
+    for (int i = 0; i < n; i++)
+    {
+        TACInstruction ins = code[i];
+        int def = ssa.def_value[i];
+
+        if (def >= 0 && lat[def].state == LATTICE_CONST)
+        {
+            // every read of a constant temporary is substituted below
+            if (tac_is_temp(ins.result))
+            {
+                folded++;
+                continue;
+            }
+            if (!(ins.op == TAC_COPY && tac_is_const(ins.arg1)))
+                folded++;
+            ins.op = TAC_COPY;
+            ins.arg1 = tac_const(lat[def].value);
+            ins.arg2 = TAC_NO_OPERAND;
+        }
+        else
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                int use = ssa.use_value[i][k];
+                if (use >= 0 && lat[use].state == LATTICE_CONST)
+                {
+                    if (k == 0)
+                        ins.arg1 = tac_const(lat[use].value);
+                    else
+                        ins.arg2 = tac_const(lat[use].value);
+                }
+            }
+        }
+        code[j++] = ins;
+    }
+    *count = j;
+
+    free(lat);
+    ssa_free(&ssa);
+    return folded;
+}
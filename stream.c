@@ -0,0 +1,341 @@
+// stream.c
+#include "headers/stream.h"
+#include "headers/symbol_table.h"
+#include "headers/lexical_analyzer.h"
+#include "headers/syntax_analyzer.h"
+#include "headers/semantic_analyzer.h"
+#include "headers/intermediate_code_generator.h"
+#include "headers/target_code_generator.h"
+#include "headers/machine_code_generator.h"
+#include "headers/diagnostics.h"
+#include "headers/pass_manager.h"
+#include "headers/parallel.h"
+
+// === READING ===
+typedef struct
+{
+    FILE *in;
+    int line; // line the next statement starts on
+    char *text;
+    size_t length;
+    size_t capacity;
+} Reader;
+
+static void put_char(Reader *r, int c)
+{
+    if (r->length + 1 >= r->capacity)
+    {
+        r->capacity = r->capacity ? r->capacity * 2 : 256;
+        char *tmp = realloc(r->text, r->capacity);
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed in compile_streaming()\n");
+            exit(1);
+        }
+        r->text = tmp;
+    }
+    r->text[r->length++] = (char)c;
+    r->text[r->length] = '\0';
+}
+
+/* Reads up to and including the next '!' that ends a statement, skipping
+   over comments and character literals the way the lexer does. Returns 0
+   at the end of the input. */
+static int next_statement(Reader *r)
+{
+    enum
+    {
+        CODE,
+        LINE_COMMENT,
+        BLOCK_COMMENT,
+        CHAR_LITERAL
+    } state = CODE;
+
+    r->length = 0;
+    if (r->text)
+        r->text[0] = '\0';
+
+    int c, prev = '\0';
+    while ((c = fgetc(r->in)) != EOF)
+    {
+        put_char(r, c);
+
+        switch (state)
+        {
+        case CODE:
+            if (c == '!')
+                return 1;
+            if (c == '\'')
+                state = CHAR_LITERAL;
+            else if (prev == '/' && c == '/')
+                state = LINE_COMMENT;
+            else if (prev == '/' && c == '*')
+            {
+                state = BLOCK_COMMENT;
+                c = '\0'; // "/*/" does not close the comment
+            }
+            break;
+        case LINE_COMMENT:
+            if (c == '\n')
+                state = CODE;
+            break;
+        case BLOCK_COMMENT:
+            if (prev == '*' && c == '/')
+            {
+                state = CODE;
+                c = '\0';
+            }
+            break;
+        case CHAR_LITERAL:
+            if (prev == '\\')
+                c = '\0'; // escaped, so '\\' cannot escape the closing quote
+            else if (c == '\'' || c == '\n')
+                state = CODE;
+            break;
+        }
+        prev = c;
+    }
+    return r->length > 0;
+}
+
+static int count_lines(const char *text)
+{
+    int lines = 0;
+    for (; *text; text++)
+        if (*text == '\n')
+            lines++;
+    return lines;
+}
+
+// === PARALLEL BACK END ===
+#define STREAM_BATCH 4096 // statements collected before the workers lower them
+
+/* With --jobs above 1, statements' optimized code is collected here and
+   lowered and encoded by the workers, each taking a run of statements
+   into its own memory streams; the streams are then written out in order. */
+typedef struct
+{
+    TACInstruction *code; // the statements' code back to back
+    int count;
+    int capacity;
+    int start[STREAM_BATCH + 1]; // statement k is code[start[k] .. start[k + 1])
+    int statements;
+
+    int slots;
+    char *assembly[MAX_JOBS];
+    size_t assembly_length[MAX_JOBS];
+    char *machine[MAX_JOBS];
+    size_t machine_length[MAX_JOBS];
+} Batch;
+
+static void add_to_batch(Batch *batch, const TACInstruction *code, int count)
+{
+    if (batch->count + count > batch->capacity)
+    {
+        int capacity = batch->capacity ? batch->capacity : 1024;
+        while (capacity < batch->count + count)
+            capacity *= 2;
+        TACInstruction *tmp = realloc(batch->code, sizeof(TACInstruction) * capacity);
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed in compile_streaming()\n");
+            exit(1);
+        }
+        batch->code = tmp;
+        batch->capacity = capacity;
+    }
+    memcpy(batch->code + batch->count, code, sizeof(TACInstruction) * count);
+    batch->start[batch->statements] = batch->count;
+    batch->count += count;
+    batch->statements++;
+    batch->start[batch->statements] = batch->count;
+}
+
+static void lower_statements(int slot, void *arg)
+{
+    Batch *batch = arg;
+    FILE *assembly = open_memstream(&batch->assembly[slot], &batch->assembly_length[slot]);
+    FILE *machine = open_memstream(&batch->machine[slot], &batch->machine_length[slot]);
+    if (!assembly || !machine)
+    {
+        fprintf(stderr, "Memory allocation failed in lower_statements()\n");
+        exit(1);
+    }
+
+    int first = (int)((long long)batch->statements * slot / batch->slots);
+    int last = (int)((long long)batch->statements * (slot + 1) / batch->slots);
+    for (int k = first; k < last; k++)
+    {
+        generate_statement_target_code(batch->code + batch->start[k], batch->start[k + 1] - batch->start[k], assembly);
+        encode_statement_code(machine);
+    }
+
+    fclose(assembly);
+    fclose(machine);
+}
+
+static void lower_batch(Batch *batch, FILE *code_file)
+{
+    if (batch->statements == 0)
+        return;
+
+    batch->slots = job_count() < batch->statements ? job_count() : batch->statements;
+    parallel_run(batch->slots, lower_statements, batch);
+
+    for (int k = 0; k < batch->slots; k++)
+    {
+        fwrite(batch->assembly[k], 1, batch->assembly_length[k], code_file);
+        fwrite(batch->machine[k], 1, batch->machine_length[k], stdout);
+        free(batch->assembly[k]);
+        free(batch->machine[k]);
+    }
+    batch->count = 0;
+    batch->statements = 0;
+}
+
+// === COMPILING ===
+static char referenced[MAX_SYMBOLS];
+static int data_order[MAX_SYMBOLS]; // variables in the order the code first uses them
+static int data_order_count = 0;
+
+// gives each variable the statement touches for the first time its .data slot
+static void assign_data_slots(const TACInstruction *code, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        const TACOperand operands[3] = {code[i].result, code[i].arg1, code[i].arg2};
+        for (int k = 0; k < 3; k++)
+        {
+            if (!tac_is_var(operands[k]) || referenced[tac_index(operands[k])])
+                continue;
+            int id = tac_index(operands[k]);
+            referenced[id] = 1;
+            data_order[data_order_count++] = id;
+            add_data_symbol(symbol_table[id].name);
+        }
+    }
+}
+
+// returns the message to stop with, or NULL once the statement's code is out (or batched)
+static const char *compile_statement(const char *text, int first_line, Batch *batch, FILE *code_file)
+{
+    if (lex_source(text, first_line))
+        return "Compilation stopped: Lexical errors found.";
+    if (token_count == 0)
+        return NULL; // only whitespace or comments
+
+    int failed = parse_tokens();
+    if (!failed)
+        failed = semantic_analyze(syntax_tree) ? 2 : 0;
+    if (failed)
+    {
+        free_ast(syntax_tree);
+        syntax_tree = NULL;
+        return failed == 1 ? "\nCompilation aborted due to syntax error."
+                           : "\nCompilation aborted due to semantic error.";
+    }
+
+    // a batch's wide constants have to last until it is lowered
+    if (!batch || batch->statements == 0)
+        reset_wide_constants();
+
+    int count = 0;
+    TACInstruction *code = generate_statement_code(syntax_tree, &count);
+    free_ast(syntax_tree);
+    syntax_tree = NULL;
+
+    assign_data_slots(code, count);
+    if (batch)
+    {
+        add_to_batch(batch, code, count);
+        if (batch->statements == STREAM_BATCH)
+            lower_batch(batch, code_file);
+    }
+    else
+    {
+        generate_statement_target_code(code, count, code_file);
+        encode_statement_code(stdout);
+    }
+    return NULL;
+}
+
+int compile_streaming(const char *path)
+{
+    Reader reader = {NULL, 1, NULL, 0, 0};
+    reader.in = fopen(path, "r");
+    if (!reader.in)
+    {
+        printf("Error: unable to open file.\n");
+        return 1;
+    }
+
+    // the generated code waits here until .data can be written in front of it
+    FILE *code_file = tmpfile();
+    if (!code_file)
+    {
+        printf("Error: unable to create a temporary file for the code.\n");
+        fclose(reader.in);
+        return 1;
+    }
+
+    Batch *batch = NULL;
+    if (job_count() > 1)
+    {
+        batch = calloc(1, sizeof(Batch));
+        if (!batch)
+        {
+            fprintf(stderr, "Memory allocation failed in compile_streaming()\n");
+            exit(1);
+        }
+    }
+
+    reset_pass_stats();
+    long long statements = 0;
+    size_t longest = 0;
+    const char *stop = NULL;
+
+    printf("\n===== STREAMING COMPILATION =====\n");
+    printf("===== MACHINE CODE =====\n");
+    while (!stop && next_statement(&reader))
+    {
+        if (reader.length > longest)
+            longest = reader.length;
+        stop = compile_statement(reader.text, reader.line, batch, code_file);
+        reader.line += count_lines(reader.text);
+        statements += token_count > 0;
+    }
+    if (batch)
+    {
+        lower_batch(batch, code_file);
+        free(batch->code);
+        free(batch);
+    }
+    printf("===== MACHINE CODE END =====\n");
+
+    fclose(reader.in);
+    free(reader.text);
+
+    int status = 0;
+    if (stop)
+    {
+        diag_flush();
+        if (diag_should_abort())
+            printf("\nToo many errors (limit reached).\n");
+        printf("%s\n", stop);
+    }
+    else
+    {
+        semantic_finish();
+        check_unused_variables();
+        diag_flush();
+        printf("\nStreamed %lld statement(s); the longest was %zu byte(s).\n\n", statements, longest);
+        print_pass_report();
+        status = write_streamed_assembly(data_order, data_order_count, code_file);
+
+        printf("\n===== SYMBOL TABLE (AFTER ANALYSIS) =====\n");
+        display_symbol_table();
+    }
+
+    fclose(code_file);
+    return status;
+}
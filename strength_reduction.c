@@ -0,0 +1,279 @@
+// strength_reduction.c
+#include "headers/strength_reduction.h"
+
+typedef struct
+{
+    TACInstruction *code; // output being built
+    int count;
+    int capacity;
+    int next_temp;
+} Sequence;
+
+static void append(Sequence *seq, TACOpcode op, TACOperand result, TACOperand arg1, TACOperand arg2)
+{
+    if (seq->count == seq->capacity)
+    {
+        seq->capacity = seq->capacity ? seq->capacity * 2 : 64;
+        TACInstruction *tmp = realloc(seq->code, sizeof(TACInstruction) * seq->capacity);
+        if (!tmp)
+        {
+            fprintf(stderr, "Memory allocation failed in strength_reduce()\n");
+            exit(1);
+        }
+        seq->code = tmp;
+    }
+    TACInstruction *ins = &seq->code[seq->count++];
+    ins->op = op;
+    ins->result = result;
+    ins->arg1 = arg1;
+    ins->arg2 = arg2;
+}
+
+static TACOperand fresh_temp(Sequence *seq)
+{
+    return tac_temp(seq->next_temp++);
+}
+
+// === MULTIPLY BY A CONSTANT ===
+/* Non-adjacent form of u: digits in {-1, 0, 1}, no two adjacent non-zero,
+   so it has the fewest non-zero digits of any signed-binary form. Stores
+   the non-zero positions (highest first) and signs; returns how many. */
+static int naf_terms(unsigned long long u, int shifts[65], int signs[65])
+{
+    int digits[66], n = 0, count = 0;
+    unsigned __int128 v = u;
+    while (v)
+    {
+        int d = 0;
+        if (v & 1)
+        {
+            d = (v & 3) == 3 ? -1 : 1;
+            v = d > 0 ? v - 1 : v + 1;
+        }
+        digits[n++] = d;
+        v >>= 1;
+    }
+    for (int i = n - 1; i >= 0; i--)
+        if (digits[i])
+        {
+            shifts[count] = i;
+            signs[count++] = digits[i];
+        }
+    return count;
+}
+
+static int multiply_sequence_cost(int terms, const int shifts[], int negate)
+{
+    int cost = (terms - 1) * COST_ALU + (negate ? COST_ALU : 0);
+    for (int i = 0; i < terms; i++)
+        if (shifts[i] > 0)
+            cost += COST_ALU;
+    return cost;
+}
+
+static TACOperand shifted(Sequence *seq, TACOperand x, int amount)
+{
+    if (amount == 0)
+        return x;
+    TACOperand t = fresh_temp(seq);
+    append(seq, TAC_SHL, t, x, tac_const(amount));
+    return t;
+}
+
+// returns 1 if result = x * c was rewritten
+static int reduce_multiply(Sequence *seq, TACOperand result, TACOperand x, long long c)
+{
+    if (c == 0 || c == 1 || c == -1)
+    {
+        if (c == 0)
+            append(seq, TAC_COPY, result, tac_const(0), TAC_NO_OPERAND);
+        else if (c == 1)
+            append(seq, TAC_COPY, result, x, TAC_NO_OPERAND);
+        else
+            append(seq, TAC_SUB, result, tac_const(0), x);
+        return 1;
+    }
+
+    int negate = c < 0;
+    unsigned long long u = negate ? 0 - (unsigned long long)c : (unsigned long long)c;
+    int shifts[65], signs[65];
+    int terms = naf_terms(u, shifts, signs);
+
+    if (multiply_sequence_cost(terms, shifts, negate) >= COST_MULTIPLY)
+        return 0;
+
+    if (terms == 1 && !negate)
+    {
+        append(seq, TAC_SHL, result, x, tac_const(shifts[0]));
+        return 1;
+    }
+
+    // acc = x << shifts[0], then +/- (x << shifts[i]); the last step writes result
+    TACOperand acc = shifted(seq, x, shifts[0]);
+    for (int i = 1; i < terms; i++)
+    {
+        TACOperand term = shifted(seq, x, shifts[i]);
+        TACOperand dst = (i == terms - 1 && !negate) ? result : fresh_temp(seq);
+        append(seq, signs[i] > 0 ? TAC_ADD : TAC_SUB, dst, acc, term);
+        acc = dst;
+    }
+
+    if (negate)
+        append(seq, TAC_SUB, result, tac_const(0), acc);
+    return 1;
+}
+
+// === DIVIDE BY A CONSTANT ===
+// Hacker's Delight, signed magic number for 64-bit division by d (|d| >= 2)
+static void signed_magic(long long d, long long *multiplier, int *shift)
+{
+    const unsigned long long two63 = 1ULL << 63;
+    unsigned long long ad = d < 0 ? 0 - (unsigned long long)d : (unsigned long long)d;
+    unsigned long long t = two63 + ((unsigned long long)d >> 63);
+    unsigned long long anc = t - 1 - t % ad;
+    unsigned long long q1 = two63 / anc, r1 = two63 - q1 * anc;
+    unsigned long long q2 = two63 / ad, r2 = two63 - q2 * ad;
+    unsigned long long delta;
+    int p = 63;
+
+    do
+    {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc)
+        {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad)
+        {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    *multiplier = (long long)(q2 + 1);
+    if (d < 0)
+        *multiplier = -*multiplier;
+    *shift = p - 64;
+}
+
+// returns 1 if result = x / d was rewritten
+static int reduce_divide(Sequence *seq, TACOperand result, TACOperand x, long long d)
+{
+    if (d == 0)
+        return 0; // traps at run time; leave it alone
+
+    if (d == 1 || d == -1)
+    {
+        if (d == 1)
+            append(seq, TAC_COPY, result, x, TAC_NO_OPERAND);
+        else
+            append(seq, TAC_SUB, result, tac_const(0), x);
+        return 1;
+    }
+
+    int negate = d < 0;
+    unsigned long long ad = negate ? 0 - (unsigned long long)d : (unsigned long long)d;
+
+    if ((ad & (ad - 1)) == 0)
+    {
+        // round toward zero: add 2^k - 1 to negative dividends before shifting
+        int k = __builtin_ctzll(ad);
+        TACOperand bias = fresh_temp(seq);
+        if (k == 1)
+            append(seq, TAC_SHR, bias, x, tac_const(63));
+        else
+        {
+            TACOperand sign = fresh_temp(seq);
+            append(seq, TAC_SAR, sign, x, tac_const(63));
+            append(seq, TAC_SHR, bias, sign, tac_const(64 - k));
+        }
+        TACOperand biased = fresh_temp(seq);
+        append(seq, TAC_ADD, biased, x, bias);
+
+        if (negate)
+        {
+            TACOperand q = fresh_temp(seq);
+            append(seq, TAC_SAR, q, biased, tac_const(k));
+            append(seq, TAC_SUB, result, tac_const(0), q);
+        }
+        else
+            append(seq, TAC_SAR, result, biased, tac_const(k));
+        return 1;
+    }
+
+    long long m;
+    int s;
+    signed_magic(d, &m, &s);
+
+    TACOperand q = fresh_temp(seq);
+    append(seq, TAC_MULHI, q, x, tac_const(m));
+    if (d > 0 && m < 0)
+    {
+        TACOperand t = fresh_temp(seq);
+        append(seq, TAC_ADD, t, q, x);
+        q = t;
+    }
+    else if (d < 0 && m > 0)
+    {
+        TACOperand t = fresh_temp(seq);
+        append(seq, TAC_SUB, t, q, x);
+        q = t;
+    }
+    if (s > 0)
+    {
+        TACOperand t = fresh_temp(seq);
+        append(seq, TAC_SAR, t, q, tac_const(s));
+        q = t;
+    }
+
+    // add one when the quotient is negative so it truncates toward zero
+    TACOperand sign = fresh_temp(seq);
+    append(seq, TAC_SHR, sign, q, tac_const(63));
+    append(seq, TAC_ADD, result, q, sign);
+    return 1;
+}
+
+int strength_reduce(TACBuffer *ir)
+{
+    if (ir->count == 0)
+        return 0;
+
+    DataflowIdSpace ids = dataflow_id_space(ir->code, ir->count);
+    Sequence seq = {NULL, 0, 0, ids.temp_count};
+    int reduced = 0;
+
+    for (int i = 0; i < ir->count; i++)
+    {
+        TACInstruction ins = ir->code[i];
+        int rewritten = 0;
+
+        // a lone read of x feeds several instructions below, which is only
+        // safe because each sequence writes result last
+        if (ins.op == TAC_MUL && tac_is_const(ins.arg2) && !tac_is_const(ins.arg1))
+            rewritten = reduce_multiply(&seq, ins.result, ins.arg1, tac_const_value(ins.arg2));
+        else if (ins.op == TAC_MUL && tac_is_const(ins.arg1) && !tac_is_const(ins.arg2))
+            rewritten = reduce_multiply(&seq, ins.result, ins.arg2, tac_const_value(ins.arg1));
+        else if (ins.op == TAC_DIV && tac_is_const(ins.arg2) && !tac_is_const(ins.arg1))
+            rewritten = reduce_divide(&seq, ins.result, ins.arg1, tac_const_value(ins.arg2));
+
+        if (rewritten)
+            reduced++;
+        else
+            append(&seq, ins.op, ins.result, ins.arg1, ins.arg2);
+    }
+
+    if (reduced)
+    {
+        tac_buffer_reserve(ir, seq.count);
+        memcpy(ir->code, seq.code, sizeof(TACInstruction) * seq.count);
+        ir->count = seq.count;
+    }
+    free(seq.code);
+    return reduced;
+}
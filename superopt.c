@@ -0,0 +1,117 @@
+// superopt.c
+#include "headers/superopt.h"
+
+// === SHAPES ===
+static int commutative(const char *op)
+{
+    return strcmp(op, "+") == 0 || strcmp(op, "*") == 0;
+}
+
+// returns 0 if the text does not fit in size
+static int node_text(const SuperoptTree *t, int n, const int *rename, char *out, size_t size)
+{
+    const SuperoptNode *node = &t->node[n];
+    int written;
+
+    if (!node->op[0])
+    {
+        if (node->var >= 0)
+            written = snprintf(out, size, "%c", 'a' + rename[node->var]);
+        else
+            written = snprintf(out, size, "%lld", node->value);
+        return written >= 0 && (size_t)written < size;
+    }
+
+    char left[SUPEROPT_MAX_SHAPE], right[SUPEROPT_MAX_SHAPE];
+    if (!node_text(t, node->left, rename, left, sizeof(left)) ||
+        !node_text(t, node->right, rename, right, sizeof(right)))
+        return 0;
+
+    if (commutative(node->op) && strcmp(left, right) > 0)
+        written = snprintf(out, size, "(%s %s %s)", node->op, right, left);
+    else
+        written = snprintf(out, size, "(%s %s %s)", node->op, left, right);
+    return written >= 0 && (size_t)written < size;
+}
+
+int superopt_shape(const SuperoptTree *t, char *key, size_t size, int *rename)
+{
+    if (t->vars > SUPEROPT_MAX_INPUTS)
+        return 0;
+
+    // try each naming of the variables and keep the smallest text
+    int naming[2][SUPEROPT_MAX_INPUTS] = {{0, 1}, {1, 0}};
+    int found = 0;
+    for (int k = 0; k < (t->vars == 2 ? 2 : 1); k++)
+    {
+        char text[SUPEROPT_MAX_SHAPE];
+        if (!node_text(t, t->root, naming[k], text, sizeof(text)) || strlen(text) >= size)
+            return 0;
+        if (!found || strcmp(text, key) < 0)
+        {
+            strcpy(key, text);
+            memcpy(rename, naming[k], sizeof(naming[k]));
+            found = 1;
+        }
+    }
+    return found;
+}
+
+const SuperoptEntry *superopt_lookup(const SuperoptEntry *table, int size, const char *shape)
+{
+    int lo = 0, hi = size - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        int c = strcmp(shape, table[mid].shape);
+        if (c == 0)
+            return &table[mid];
+        if (c < 0)
+            hi = mid - 1;
+        else
+            lo = mid + 1;
+    }
+    return NULL;
+}
+
+// === SEMANTICS ===
+int superopt_step_cost(SuperoptOpcode op)
+{
+    return op == SO_DMULT ? 6 : 1;
+}
+
+long long superopt_apply(const char *op, long long a, long long b)
+{
+    unsigned long long ua = (unsigned long long)a, ub = (unsigned long long)b;
+    if (strcmp(op, "+") == 0)
+        return (long long)(ua + ub);
+    if (strcmp(op, "-") == 0)
+        return (long long)(ua - ub);
+    if (strcmp(op, "*") == 0)
+        return (long long)(ua * ub);
+    if (strcmp(op, "<<") == 0)
+        return (long long)(ua << (b & 63));
+    if (strcmp(op, ">>") == 0)
+        return a >> (b & 63);
+    if (strcmp(op, ">>>") == 0)
+        return (long long)(ua >> (b & 63));
+    return 0;
+}
+
+long long superopt_run(const SuperoptStep *step, int steps, int result, const long long *inputs)
+{
+    long long value[2 + SUPEROPT_MAX_STEPS + 1];
+    long long *v = value + 1; // v[-1] is r0
+    v[-1] = 0;
+    v[0] = inputs[0];
+    v[1] = inputs[1];
+
+    for (int k = 0; k < steps; k++)
+    {
+        long long a = v[step[k].src1], b = step[k].op <= SO_DMULT ? v[step[k].src2] : step[k].imm;
+        static const char *ops[] = {[SO_DADDU] = "+", [SO_DSUBU] = "-", [SO_DMULT] = "*", [SO_DSLL] = "<<",
+                                    [SO_DSRA] = ">>", [SO_DSRL] = ">>>", [SO_DADDIU] = "+"};
+        v[2 + k] = superopt_apply(ops[step[k].op], a, b);
+    }
+    return v[result];
+}
@@ -0,0 +1,38 @@
+// superopt_table.c
+// Generated by superoptimizer.c; regenerate instead of editing.
+#include "headers/superopt.h"
+
+const SuperoptEntry superopt_table[] = {
+    {"(* (+ 1 a) (- a 1))", 12, 8, 2, 3, {{SO_DMULT, 0, 0, 0}, {SO_DADDIU, 2, 0, -1}}},
+    {"(* (+ a b) (+ a b))", 12, 9, 2, 3, {{SO_DADDU, 0, 1, 0}, {SO_DMULT, 2, 2, 0}}},
+    {"(* (- a b) (- a b))", 12, 9, 2, 3, {{SO_DSUBU, 0, 1, 0}, {SO_DMULT, 2, 2, 0}}},
+    {"(* 10 a)", 8, 4, 3, 4, {{SO_DADDU, 0, 0, 0}, {SO_DSLL, 0, 0, 3}, {SO_DADDU, 2, 3, 0}}},
+    {"(* 2 a)", 8, 2, 1, 2, {{SO_DADDU, 0, 0, 0}}},
+    {"(* 3 a)", 8, 3, 2, 3, {{SO_DADDU, 0, 0, 0}, {SO_DADDU, 0, 2, 0}}},
+    {"(* 4 a)", 8, 2, 1, 2, {{SO_DSLL, 0, 0, 2}}},
+    {"(* 5 a)", 8, 3, 2, 3, {{SO_DSLL, 0, 0, 2}, {SO_DADDU, 0, 2, 0}}},
+    {"(* 7 a)", 8, 3, 2, 3, {{SO_DSLL, 0, 0, 3}, {SO_DSUBU, 2, 0, 0}}},
+    {"(* 8 a)", 8, 2, 1, 2, {{SO_DSLL, 0, 0, 3}}},
+    {"(* 9 a)", 8, 3, 2, 3, {{SO_DSLL, 0, 0, 3}, {SO_DADDU, 0, 2, 0}}},
+    {"(+ (* 3 a) 1)", 10, 4, 3, 4, {{SO_DADDU, 0, 0, 0}, {SO_DADDU, 0, 2, 0}, {SO_DADDIU, 3, 0, 1}}},
+    {"(+ (* a a) a)", 10, 8, 2, 3, {{SO_DMULT, 0, 0, 0}, {SO_DADDU, 2, 0, 0}}},
+    {"(+ (* a b) a)", 10, 9, 2, 3, {{SO_DMULT, 0, 1, 0}, {SO_DADDU, 2, 0, 0}}},
+    {"(+ (+ (<< a 2) a) 1)", 6, 4, 3, 4, {{SO_DSLL, 0, 0, 2}, {SO_DADDU, 2, 0, 0}, {SO_DADDIU, 3, 0, 1}}},
+    {"(+ (- (<< a 2) a) 1)", 6, 4, 3, 4, {{SO_DSLL, 0, 0, 2}, {SO_DSUBU, 2, 0, 0}, {SO_DADDIU, 3, 0, 1}}},
+    {"(+ (- a b) b)", 5, 1, 0, 0, {{0}}},
+    {"(+ (<< a 1) (<< a 3))", 5, 4, 3, 4, {{SO_DSLL, 0, 0, 1}, {SO_DSLL, 0, 0, 3}, {SO_DADDU, 2, 3, 0}}},
+    {"(+ (<< a 2) a)", 4, 3, 2, 3, {{SO_DSLL, 0, 0, 2}, {SO_DADDU, 2, 0, 0}}},
+    {"(+ (<< a 3) a)", 4, 3, 2, 3, {{SO_DSLL, 0, 0, 3}, {SO_DADDU, 2, 0, 0}}},
+    {"(+ 1 a)", 3, 2, 1, 2, {{SO_DADDIU, 0, 0, 1}}},
+    {"(- (* a a) a)", 10, 8, 2, 3, {{SO_DMULT, 0, 0, 0}, {SO_DSUBU, 2, 0, 0}}},
+    {"(- (+ a b) a)", 5, 1, 0, 1, {{0}}},
+    {"(- (<< a 2) a)", 4, 3, 2, 3, {{SO_DSLL, 0, 0, 2}, {SO_DSUBU, 2, 0, 0}}},
+    {"(- (<< a 3) a)", 4, 3, 2, 3, {{SO_DSLL, 0, 0, 3}, {SO_DSUBU, 2, 0, 0}}},
+    {"(- 0 a)", 3, 2, 1, 2, {{SO_DSUBU, -1, 0, 0}}},
+    {"(- a (- 0 b))", 5, 3, 1, 2, {{SO_DADDU, 0, 1, 0}}},
+    {"(- a 1)", 3, 2, 1, 2, {{SO_DADDIU, 0, 0, -1}}},
+    {"(>> (+ (>>> (>> a 63) 62) a) 2)", 6, 5, 4, 5, {{SO_DSRA, 0, 0, 63}, {SO_DSRL, 2, 0, 62}, {SO_DADDU, 3, 0, 0}, {SO_DSRA, 4, 0, 2}}},
+    {"(>> (+ (>>> (>> a 63) 63) a) 1)", 6, 4, 3, 4, {{SO_DSRA, 0, 0, 63}, {SO_DSUBU, 0, 2, 0}, {SO_DSRA, 3, 0, 1}}},
+};
+
+const int superopt_table_size = 30;
@@ -0,0 +1,580 @@
+// superoptimizer.c
+/* Offline superoptimizer for the backend's expression shapes. Not part
+   of the compiler; build and run it on its own to regenerate the table:
+
+     gcc -O2 superoptimizer.c superopt.c -o superoptimizer
+     ./superoptimizer > superopt_table.c
+
+   Shapes given on the command line (e.g. "(+ (* a 3) 1)") replace the
+   built-in list. For each shape it enumerates every sequence of up to
+   SEARCH_DEPTH instructions from the subset the backend emits (daddu,
+   dsubu, dmult/mflo, dsll, dsra, dsrl, daddiu), starting from none at
+   all when the shape is just an input or zero, keeps the cheapest one
+   that agrees with the shape on random 64-bit inputs and on every input
+   from -128 to 127, and writes it out if it beats the lowering the
+   backend would otherwise use. */
+#include <stdint.h>
+#include "headers/superopt.h"
+
+#define SEARCH_DEPTH 3
+#define QUICK_TESTS 8
+#define RANDOM_TESTS 2000
+#define SMALL_MIN -128
+#define SMALL_MAX 127
+
+// hot shapes: what the strength reducer and the -O0 lowering leave behind
+static const char *default_shapes[] = {
+    "(+ a 1)",
+    "(- a 1)",
+    "(+ a b)",
+    "(- 0 a)",
+    "(* a 2)",
+    "(* a 3)",
+    "(* a 4)",
+    "(* a 5)",
+    "(* a 7)",
+    "(* a 8)",
+    "(* a 9)",
+    "(* a 10)",
+    "(+ (* a 3) 1)",
+    "(+ (<< a 2) a)",
+    "(- (<< a 2) a)",
+    "(- (<< a 3) a)",
+    "(+ (<< a 3) a)",
+    "(+ (<< a 3) (<< a 1))",
+    "(+ (- (<< a 2) a) 1)",
+    "(+ (+ (<< a 2) a) 1)",
+    "(* (- a b) (- a b))",
+    "(* (+ a b) (+ a b))",
+    "(+ (* a b) a)",
+    "(+ (* a a) a)",
+    "(- (* a a) a)",
+    "(* (+ a 1) (- a 1))",
+    "(+ (- a b) b)",
+    "(- (+ a b) b)",
+    "(- a (- 0 b))",
+    "(>> (+ a (>>> (>> a 63) 63)) 1)",
+    "(>> (+ a (>>> (>> a 63) 62)) 2)",
+};
+
+// === SHAPES ===
+static const char *skip_spaces(const char *s)
+{
+    while (*s == ' ')
+        s++;
+    return s;
+}
+
+// returns the node index, or -1 on a syntax error
+static int parse_node(SuperoptTree *t, const char **text)
+{
+    const char *s = skip_spaces(*text);
+    if (t->count == (int)(sizeof(t->node) / sizeof(t->node[0])))
+        return -1;
+    int n = t->count++;
+    SuperoptNode *node = &t->node[n];
+    memset(node, 0, sizeof(*node));
+
+    if (*s == '(')
+    {
+        s = skip_spaces(s + 1);
+        int len = 0;
+        while (s[len] && s[len] != ' ' && len < 3)
+            len++;
+        memcpy(node->op, s, len);
+        node->op[len] = '\0';
+        s += len;
+        node->left = parse_node(t, &s);
+        if (node->left < 0)
+            return -1;
+        node->right = parse_node(t, &s);
+        if (node->right < 0)
+            return -1;
+        s = skip_spaces(s);
+        if (*s != ')')
+            return -1;
+        *text = s + 1;
+        return n;
+    }
+
+    if (*s >= 'a' && *s < 'a' + SUPEROPT_MAX_INPUTS)
+    {
+        node->var = *s - 'a';
+        if (node->var + 1 > t->vars)
+            t->vars = node->var + 1;
+        *text = s + 1;
+        return n;
+    }
+
+    char *end;
+    node->var = -1;
+    node->value = strtoll(s, &end, 10);
+    if (end == s)
+        return -1;
+    *text = end;
+    return n;
+}
+
+static int parse_shape(const char *text, SuperoptTree *t)
+{
+    memset(t, 0, sizeof(*t));
+    t->root = parse_node(t, &text);
+    return t->root >= 0 && *skip_spaces(text) == '\0';
+}
+
+static long long eval_node(const SuperoptTree *t, int n, const long long *inputs)
+{
+    const SuperoptNode *node = &t->node[n];
+    if (!node->op[0])
+        return node->var >= 0 ? inputs[node->var] : node->value;
+    return superopt_apply(node->op, eval_node(t, node->left, inputs), eval_node(t, node->right, inputs));
+}
+
+// === BASELINE ===
+static int fits_immediate(long long v)
+{
+    return v >= -32768 && v <= 32767;
+}
+
+static int is_shift(const char *op)
+{
+    return op[0] == '<' || op[0] == '>';
+}
+
+/* What target_code_generator.c spends on the tree one TAC instruction at
+   a time: every variable operand is loaded again, every constant operand
+   other than a shift amount is materialized, and the product goes
+   through dmult/mflo. */
+static int baseline_cost(const SuperoptTree *t, int n)
+{
+    const SuperoptNode *node = &t->node[n];
+    int cost = strcmp(node->op, "*") == 0 ? superopt_step_cost(SO_DMULT) : 1;
+    int children[2] = {node->left, node->right};
+    for (int k = 0; k < 2; k++)
+    {
+        const SuperoptNode *child = &t->node[children[k]];
+        if (child->op[0])
+            cost += baseline_cost(t, children[k]);
+        else if (child->var >= 0)
+            cost++; // ld
+        else if (!(k == 1 && is_shift(node->op)))
+            cost++; // daddiu rX, r0, c
+    }
+    return cost;
+}
+
+// === CANDIDATES ===
+typedef struct
+{
+    SuperoptStep step[SUPEROPT_MAX_STEPS];
+    int steps;
+    int result; // value number of the expression
+    int cost;   // -1 until a sequence is found
+} Candidate;
+
+static int candidate_cost(const SuperoptStep *step, int steps, int result)
+{
+    int used[SUPEROPT_MAX_INPUTS] = {0};
+    int cost = 0;
+    if (steps == 0 && result >= 0)
+        used[result] = 1;
+    for (int k = 0; k < steps; k++)
+    {
+        cost += superopt_step_cost(step[k].op);
+        int srcs[2] = {step[k].src1, step[k].op <= SO_DMULT ? step[k].src2 : -1};
+        for (int s = 0; s < 2; s++)
+            if (srcs[s] >= 0 && srcs[s] < SUPEROPT_MAX_INPUTS)
+                used[srcs[s]] = 1;
+    }
+    for (int i = 0; i < SUPEROPT_MAX_INPUTS; i++)
+        cost += used[i]; // one ld per variable the sequence reads
+    return cost;
+}
+
+static int add_step(Candidate *c, SuperoptOpcode op, int src1, int src2, int imm)
+{
+    if (c->steps == SUPEROPT_MAX_STEPS)
+        return -100;
+    SuperoptStep *s = &c->step[c->steps++];
+    s->op = op;
+    s->src1 = (signed char)src1;
+    s->src2 = (signed char)src2;
+    s->imm = (short)imm;
+    return 2 + c->steps - 1;
+}
+
+static int same_node(const SuperoptTree *t, int x, int y)
+{
+    const SuperoptNode *a = &t->node[x], *b = &t->node[y];
+    if (strcmp(a->op, b->op) != 0)
+        return 0;
+    if (!a->op[0])
+        return a->var == b->var && (a->var >= 0 || a->value == b->value);
+    return same_node(t, a->left, b->left) && same_node(t, a->right, b->right);
+}
+
+typedef struct
+{
+    int node[2 * SUPEROPT_MAX_OPS + 1];
+    int value[2 * SUPEROPT_MAX_OPS + 1];
+    int count;
+} Lowered;
+
+/* The direct translation, but loading each variable once, computing equal
+   subtrees once and using daddiu for small constant operands of + and -.
+   Returns node n's value number, or -100 if it cannot be expressed. */
+static int lower_node(const SuperoptTree *t, int n, Candidate *c, Lowered *done)
+{
+    const SuperoptNode *node = &t->node[n];
+    if (!node->op[0])
+    {
+        if (node->var >= 0)
+            return node->var;
+        if (!fits_immediate(node->value))
+            return -100;
+        return node->value == 0 ? -1 : add_step(c, SO_DADDIU, -1, 0, (int)node->value);
+    }
+
+    for (int k = 0; k < done->count; k++)
+        if (same_node(t, done->node[k], n))
+            return done->value[k];
+
+    const SuperoptNode *l = &t->node[node->left], *r = &t->node[node->right];
+    int v;
+    if (is_shift(node->op))
+    {
+        int src = lower_node(t, node->left, c, done);
+        if (src == -100 || r->op[0] || r->var >= 0 || r->value < 0 || r->value > 63)
+            return -100;
+        SuperoptOpcode op = node->op[1] == '<' ? SO_DSLL : strcmp(node->op, ">>") == 0 ? SO_DSRA : SO_DSRL;
+        v = add_step(c, op, src, 0, (int)r->value);
+    }
+    else if (strcmp(node->op, "*") != 0 && !r->op[0] && r->var < 0 &&
+             fits_immediate(node->op[0] == '-' ? -r->value : r->value))
+    {
+        int src = lower_node(t, node->left, c, done);
+        if (src == -100)
+            return -100;
+        v = add_step(c, SO_DADDIU, src, 0, (int)(node->op[0] == '-' ? -r->value : r->value));
+    }
+    else if (node->op[0] == '+' && !l->op[0] && l->var < 0 && fits_immediate(l->value))
+    {
+        int src = lower_node(t, node->right, c, done);
+        if (src == -100)
+            return -100;
+        v = add_step(c, SO_DADDIU, src, 0, (int)l->value);
+    }
+    else
+    {
+        int a = lower_node(t, node->left, c, done);
+        int b = a == -100 ? -100 : lower_node(t, node->right, c, done);
+        if (b == -100)
+            return -100;
+        v = add_step(c, node->op[0] == '+' ? SO_DADDU : node->op[0] == '-' ? SO_DSUBU : SO_DMULT, a, b, 0);
+    }
+
+    if (v != -100)
+    {
+        done->node[done->count] = n;
+        done->value[done->count++] = v;
+    }
+    return v;
+}
+
+static int lower_direct(const SuperoptTree *t, Candidate *c)
+{
+    Lowered done;
+    done.count = 0;
+    c->steps = 0;
+    int v = lower_node(t, t->root, c, &done);
+    // the result has to come out of the last step
+    if (v == -100 || v != 2 + c->steps - 1)
+        return 0;
+    c->result = v;
+    c->cost = candidate_cost(c->step, c->steps, c->result);
+    return 1;
+}
+
+// === VERIFICATION ===
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ULL;
+
+static long long random_value(void)
+{
+    // xorshift64*, with extra weight on values near 0 and the extremes
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    unsigned long long r = rng_state * 0x2545F4914F6CDD1DULL;
+    switch (r & 7)
+    {
+    case 0:
+        return (long long)(r >> 3) % 64 - 32;
+    case 1:
+        return (long long)((r >> 3) | (1ULL << 63));
+    default:
+        return (long long)r;
+    }
+}
+
+static int verify(const SuperoptTree *t, const Candidate *c)
+{
+    long long in[2];
+    for (int k = 0; k < RANDOM_TESTS; k++)
+    {
+        in[0] = random_value();
+        in[1] = random_value();
+        if (superopt_run(c->step, c->steps, c->result, in) != eval_node(t, t->root, in))
+            return 0;
+    }
+
+    // every input pair in the small range
+    for (in[0] = SMALL_MIN; in[0] <= SMALL_MAX; in[0]++)
+        for (in[1] = t->vars > 1 ? SMALL_MIN : 0; in[1] <= (t->vars > 1 ? SMALL_MAX : 0); in[1]++)
+            if (superopt_run(c->step, c->steps, c->result, in) != eval_node(t, t->root, in))
+                return 0;
+    return 1;
+}
+
+// === SEARCH ===
+typedef struct
+{
+    const SuperoptTree *tree;
+    long long inputs[QUICK_TESTS][2];
+    long long expected[QUICK_TESTS];
+    int immediates[16];
+    int immediate_count;
+    Candidate current;
+    Candidate best;
+    long long values[SEARCH_DEPTH + 3][QUICK_TESTS]; // [value number + 1][test]
+} Search;
+
+static long long step_value(const Search *s, const SuperoptStep *st, int test)
+{
+    long long a = s->values[st->src1 + 1][test];
+    switch (st->op)
+    {
+    case SO_DADDU:
+        return (long long)((unsigned long long)a + (unsigned long long)s->values[st->src2 + 1][test]);
+    case SO_DSUBU:
+        return (long long)((unsigned long long)a - (unsigned long long)s->values[st->src2 + 1][test]);
+    case SO_DMULT:
+        return (long long)((unsigned long long)a * (unsigned long long)s->values[st->src2 + 1][test]);
+    case SO_DSLL:
+        return (long long)((unsigned long long)a << st->imm);
+    case SO_DSRA:
+        return a >> st->imm;
+    case SO_DSRL:
+        return (long long)((unsigned long long)a >> st->imm);
+    case SO_DADDIU:
+        return (long long)((unsigned long long)a + (unsigned long long)(long long)st->imm);
+    }
+    return 0;
+}
+
+static void try_step(Search *s, int depth, int limit, SuperoptOpcode op, int src1, int src2, int imm);
+
+static void extend(Search *s, int depth, int limit)
+{
+    int values = 2 + depth; // value numbers -1 .. values - 1 exist
+    for (int a = -1; a < values; a++)
+    {
+        if (a == 1 && s->tree->vars < 2)
+            continue;
+        for (int b = -1; b < values; b++)
+        {
+            if (b == 1 && s->tree->vars < 2)
+                continue;
+            if (a >= 0 && b >= 0 && a <= b)
+            {
+                try_step(s, depth, limit, SO_DADDU, a, b, 0);
+                try_step(s, depth, limit, SO_DMULT, a, b, 0);
+            }
+            // a plain move: daddu x, a, r0
+            if (a >= 0 && b == -1)
+                try_step(s, depth, limit, SO_DADDU, a, b, 0);
+            if (b >= 0 && a != b)
+                try_step(s, depth, limit, SO_DSUBU, a, b, 0);
+        }
+        if (a >= 0)
+            for (int amount = 1; amount < 64; amount++)
+            {
+                try_step(s, depth, limit, SO_DSLL, a, 0, amount);
+                try_step(s, depth, limit, SO_DSRA, a, 0, amount);
+                try_step(s, depth, limit, SO_DSRL, a, 0, amount);
+            }
+        for (int k = 0; k < s->immediate_count; k++)
+            try_step(s, depth, limit, SO_DADDIU, a, 0, s->immediates[k]);
+    }
+}
+
+static void try_step(Search *s, int depth, int limit, SuperoptOpcode op, int src1, int src2, int imm)
+{
+    Candidate *c = &s->current;
+    SuperoptStep *st = &c->step[depth];
+    st->op = op;
+    st->src1 = (signed char)src1;
+    st->src2 = (signed char)src2;
+    st->imm = (short)imm;
+
+    // even a one-cycle step per remaining slot would not beat the best so far
+    c->steps = depth + 1;
+    c->result = 2 + depth;
+    if (s->best.cost >= 0 && candidate_cost(c->step, c->steps, c->result) + (limit - depth - 1) >= s->best.cost)
+        return;
+
+    if (depth + 1 < limit)
+    {
+        for (int t = 0; t < QUICK_TESTS; t++)
+            s->values[depth + 3][t] = step_value(s, st, t);
+        extend(s, depth + 1, limit);
+        return;
+    }
+
+    for (int t = 0; t < QUICK_TESTS; t++)
+        if (step_value(s, st, t) != s->expected[t])
+            return;
+    if (verify(s->tree, c))
+    {
+        s->best = *c;
+        s->best.cost = candidate_cost(c->step, c->steps, c->result);
+    }
+}
+
+static void add_immediate(Search *s, long long v)
+{
+    if (v == 0 || !fits_immediate(v) || s->immediate_count == (int)(sizeof(s->immediates) / sizeof(int)))
+        return;
+    for (int k = 0; k < s->immediate_count; k++)
+        if (s->immediates[k] == v)
+            return;
+    s->immediates[s->immediate_count++] = (int)v;
+}
+
+// the cheapest sequence found, or the direct translation if nothing shorter exists
+static Candidate superoptimize(const SuperoptTree *t)
+{
+    static Search s; // large; one search at a time
+    memset(&s, 0, sizeof(s));
+    s.tree = t;
+    s.best.cost = -1;
+
+    for (int k = 0; k < t->count; k++)
+        if (!t->node[k].op[0] && t->node[k].var < 0)
+        {
+            add_immediate(&s, t->node[k].value);
+            add_immediate(&s, -t->node[k].value);
+        }
+    add_immediate(&s, 1);
+    add_immediate(&s, -1);
+
+    for (int test = 0; test < QUICK_TESTS; test++)
+    {
+        s.inputs[test][0] = random_value();
+        s.inputs[test][1] = random_value();
+        s.expected[test] = eval_node(t, t->root, s.inputs[test]);
+        s.values[0][test] = 0;
+        s.values[1][test] = s.inputs[test][0];
+        s.values[2][test] = s.inputs[test][1];
+    }
+
+    Candidate direct;
+    if (lower_direct(t, &direct) && verify(t, &direct))
+        s.best = direct;
+
+    // no instructions at all: the expression is r0 or one of the inputs
+    for (int v = -1; v < t->vars; v++)
+    {
+        Candidate none = {.steps = 0, .result = v};
+        none.cost = candidate_cost(none.step, 0, v);
+        if ((s.best.cost < 0 || none.cost < s.best.cost) && verify(t, &none))
+            s.best = none;
+    }
+
+    // shortest first; a longer sequence only wins with cheaper steps
+    for (int limit = 1; limit <= SEARCH_DEPTH; limit++)
+        if (s.best.cost < 0 || s.best.cost > limit)
+            extend(&s, 0, limit);
+    return s.best;
+}
+
+// === OUTPUT ===
+typedef struct
+{
+    char shape[SUPEROPT_MAX_SHAPE];
+    int baseline;
+    Candidate found;
+} Result;
+
+static int compare_results(const void *a, const void *b)
+{
+    return strcmp(((const Result *)a)->shape, ((const Result *)b)->shape);
+}
+
+static const char *opcode_names[] = {"SO_DADDU", "SO_DSUBU", "SO_DMULT", "SO_DSLL",
+                                     "SO_DSRA",  "SO_DSRL",  "SO_DADDIU"};
+
+int main(int argc, char **argv)
+{
+    int shape_count = argc > 1 ? argc - 1 : (int)(sizeof(default_shapes) / sizeof(default_shapes[0]));
+    const char **shapes = argc > 1 ? (const char **)argv + 1 : default_shapes;
+
+    Result *results = calloc(shape_count, sizeof(Result));
+    if (!results)
+    {
+        fprintf(stderr, "Memory allocation failed in superoptimizer\n");
+        return 1;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < shape_count; i++)
+    {
+        SuperoptTree t;
+        int rename[SUPEROPT_MAX_INPUTS];
+        Result *r = &results[kept];
+
+        // parse, then parse the canonical text again so a and b mean what the key says
+        if (!parse_shape(shapes[i], &t) || !superopt_shape(&t, r->shape, sizeof(r->shape), rename) ||
+            !parse_shape(r->shape, &t) || t.count > 2 * SUPEROPT_MAX_OPS + 1)
+        {
+            fprintf(stderr, "skipped '%s': not a shape\n", shapes[i]);
+            continue;
+        }
+
+        int duplicate = 0;
+        for (int k = 0; k < kept; k++)
+            duplicate |= strcmp(results[k].shape, r->shape) == 0;
+        if (duplicate)
+            continue;
+
+        r->baseline = baseline_cost(&t, t.root);
+        r->found = superoptimize(&t);
+        fprintf(stderr, "%-36s baseline %2d, best %2d in %d step(s)\n", r->shape, r->baseline, r->found.cost,
+                r->found.steps);
+        if (r->found.cost >= 0 && r->found.cost < r->baseline)
+            kept++;
+    }
+
+    qsort(results, kept, sizeof(Result), compare_results);
+
+    printf("// superopt_table.c\n");
+    printf("// Generated by superoptimizer.c; regenerate instead of editing.\n");
+    printf("#include \"headers/superopt.h\"\n\n");
+    printf("const SuperoptEntry superopt_table[] = {\n");
+    for (int i = 0; i < kept; i++)
+    {
+        const Result *r = &results[i];
+        printf("    {\"%s\", %d, %d, %d, %d, {", r->shape, r->baseline, r->found.cost, r->found.steps,
+               r->found.result);
+        for (int k = 0; k < r->found.steps; k++)
+        {
+            const SuperoptStep *st = &r->found.step[k];
+            printf("%s{%s, %d, %d, %d}", k ? ", " : "", opcode_names[st->op], st->src1, st->src2, st->imm);
+        }
+        printf("%s}},\n", r->found.steps ? "" : "{0}");
+    }
+    printf("};\n\n");
+    printf("const int superopt_table_size = %d;\n", kept);
+
+    free(results);
+    return 0;
+}
@@ -11,7 +11,7 @@ int add_symbol(const char *name, const char *datatype, const char *value_str, in
     {
         if (strcmp(symbol_table[i].name, name) == 0)
         {
-            printf("Semantic Error: Redeclaration of variable '%s' (previously declared as '%s')\n", name, symbol_table[i].datatype);
+            diag_report(DIAG_SYM_REDECLARATION, 0, name, name, symbol_table[i].datatype);
             return 0;
         }
     }
@@ -19,7 +19,7 @@ int add_symbol(const char *name, const char *datatype, const char *value_str, in
     // Check for overflow
     if (symbol_count >= MAX_SYMBOLS)
     {
-        printf("Symbol Table Overflow: Too many symbols.\n");
+        diag_report(DIAG_SYM_OVERFLOW, 0, name);
         return 0;
     }
 
@@ -51,7 +51,7 @@ int update_symbol_value(const char *id, const char *datatype, const char *value_
 
     if (index == -1)
     {
-        printf("Semantic Error: Undeclared variable '%s' used in assignment.\n", id);
+        diag_report(DIAG_SYM_UNDECLARED_ASSIGN, 0, id, id);
         return 0;
     }
 
@@ -60,8 +60,7 @@ int update_symbol_value(const char *id, const char *datatype, const char *value_
         strlen(symbol_table[index].datatype) > 0 &&
         strcmp(symbol_table[index].datatype, datatype) != 0)
     {
-        printf("Semantic Warning: Type mismatch assigning to '%s' (%s <- %s)\n",
-               id, symbol_table[index].datatype, datatype);
+        diag_report(DIAG_SYM_TYPE_MISMATCH, 0, id, id, symbol_table[index].datatype, datatype);
     }
 
     strcpy(symbol_table[index].value_str, value_str);
@@ -43,9 +43,11 @@ void error(const char *message)
 {
     if (!syntax_error) // avoid spamming same error
     {
-        printf("Syntax Error: %s (near token '%s')\n",
-               message,
-               current_token < token_count ? tokens[current_token].lexeme : "EOF");
+        int at_end = current_token >= token_count;
+        diag_report(DIAG_SYNTAX,
+                    at_end ? (token_count ? tokens[token_count - 1].line : 0) : tokens[current_token].line,
+                    at_end ? "EOF" : tokens[current_token].lexeme,
+                    message);
     }
     syntax_error = 1;
 }
@@ -64,6 +66,7 @@ ASTNode *create_node(NodeType type, const char *value, ASTNode *left, ASTNode *r
     }
 
     node->type = type;
+    node->line = current_token > 0 && current_token <= token_count ? tokens[current_token - 1].line : 0;
     node->left = left;
     node->right = right;
 
@@ -182,8 +185,8 @@ ASTNode *parse_statement()
         stmt_node = parse_expression();
     }
 
-    if (!match(";"))
-        error("Missing ';' after statement");
+    if (!match("!"))
+        error("Missing '!' after statement");
 
     return create_node(NODE_STATEMENT, "STATEMENT", stmt_node, NULL);
 }
@@ -441,12 +444,19 @@ void free_ast(ASTNode *node)
 }
 
 // === ENTRY POINT ===
-int syntax_analyzer()
+// parses tokens[] into syntax_tree without printing it; returns syntax_error
+int parse_tokens()
 {
     current_token = 0;
     syntax_error = 0;
 
     syntax_tree = parse_program();
+    return syntax_error;
+}
+
+int syntax_analyzer()
+{
+    parse_tokens();
     print_ast(syntax_tree, 0);
 
     if (syntax_error == 0 && current_token == token_count)
@@ -0,0 +1,281 @@
+// tac_file.c
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "headers/tac_file.h"
+
+static void *mapping = NULL;
+static size_t mappingSize = 0;
+
+// === WRITING ===
+// temporaries numbered in order of definition, so every index is below count
+static TACInstruction *renumber_temps(const TACInstruction *code, int count)
+{
+    int maxTemp = -1;
+    for (int i = 0; i < count; i++)
+        if (tac_is_temp(code[i].result) && tac_index(code[i].result) > maxTemp)
+            maxTemp = tac_index(code[i].result);
+
+    TACInstruction *copy = malloc(sizeof(TACInstruction) * (count > 0 ? count : 1));
+    int *number = malloc(sizeof(int) * (maxTemp + 1 > 0 ? maxTemp + 1 : 1));
+    if (!copy || !number)
+    {
+        fprintf(stderr, "Memory allocation failed in renumber_temps()\n");
+        exit(1);
+    }
+
+    int next = 0;
+    for (int i = 0; i < count; i++)
+    {
+        copy[i] = code[i];
+        if (tac_is_temp(copy[i].arg1))
+            copy[i].arg1 = tac_temp(number[tac_index(copy[i].arg1)]);
+        if (tac_is_temp(copy[i].arg2))
+            copy[i].arg2 = tac_temp(number[tac_index(copy[i].arg2)]);
+        if (tac_is_temp(copy[i].result))
+        {
+            number[tac_index(copy[i].result)] = next;
+            copy[i].result = tac_temp(next++);
+        }
+    }
+
+    free(number);
+    return copy;
+}
+
+int tac_write_binary(const char *path, const TACInstruction *code, int count)
+{
+    int constants = 0;
+    const long long *pool = tac_constant_pool(&constants);
+
+    TACFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TAC_FILE_MAGIC, 4);
+    header.version = TAC_FILE_VERSION;
+    header.byte_order = TAC_FILE_BYTE_ORDER;
+    header.instruction_count = count;
+    header.constant_count = constants;
+    header.symbol_count = symbol_count;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        printf("Error: cannot write TAC file '%s'.\n", path);
+        return 1;
+    }
+
+    TACInstruction *renumbered = renumber_temps(code, count);
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (count > 0)
+        ok = ok && fwrite(renumbered, sizeof(TACInstruction), count, fp) == (size_t)count;
+    free(renumbered);
+    if (constants > 0)
+        ok = ok && fwrite(pool, sizeof(long long), constants, fp) == (size_t)constants;
+    for (int i = 0; i < symbol_count && ok; i++)
+    {
+        TACFileSymbol s;
+        memset(&s, 0, sizeof(s));
+        // same sizes as the symbol table's fields
+        memcpy(s.name, symbol_table[i].name, sizeof(s.name));
+        memcpy(s.datatype, symbol_table[i].datatype, sizeof(s.datatype));
+        s.initialized = symbol_table[i].initialized;
+        ok = fwrite(&s, sizeof(s), 1, fp) == 1;
+    }
+
+    if (fclose(fp) != 0 || !ok)
+    {
+        printf("Error: failed writing TAC file '%s'.\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// the same instructions as the OPTIMIZED CODE listing, after the symbols they name
+int tac_write_text(const char *path, const TACInstruction *code, int count)
+{
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+    {
+        printf("Error: cannot write TAC file '%s'.\n", path);
+        return 1;
+    }
+
+    fprintf(fp, "# BaiScript TAC version %d\n", TAC_FILE_VERSION);
+    fprintf(fp, "symbols %d\n", symbol_count);
+    for (int i = 0; i < symbol_count; i++)
+        fprintf(fp, "%s %s %d\n", symbol_table[i].name, symbol_table[i].datatype, symbol_table[i].initialized);
+
+    fprintf(fp, "code %d\n", count);
+    for (int i = 0; i < count; i++)
+    {
+        char result[64], arg1[64], arg2[64];
+        tac_operand_text(code[i].result, result, sizeof(result));
+        tac_operand_text(code[i].arg1, arg1, sizeof(arg1));
+        if (code[i].op == TAC_COPY)
+            fprintf(fp, "%s = %s\n", result, arg1);
+        else
+            fprintf(fp, "%s = %s %s %s\n", result, arg1, tac_opcode_symbol(code[i].op),
+                    tac_operand_text(code[i].arg2, arg2, sizeof(arg2)));
+    }
+
+    if (fclose(fp) != 0)
+    {
+        printf("Error: failed writing TAC file '%s'.\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// === LOADING ===
+/* defined[] marks the temporaries written so far; the writer numbers them
+   in order of definition, so each is below instruction_count */
+static int valid_operand(TACOperand o, const TACFileHeader *h, const char *defined, int allow_none)
+{
+    switch (tac_kind(o))
+    {
+    case TAC_NONE:
+        return allow_none && o == TAC_NO_OPERAND;
+    case TAC_VAR:
+        return (unsigned)tac_index(o) < h->symbol_count;
+    case TAC_TEMP:
+        return (unsigned)tac_index(o) < h->instruction_count && defined[tac_index(o)];
+    case TAC_CONST:
+        return 1;
+    case TAC_WIDE_CONST:
+        return (unsigned)tac_index(o) < h->constant_count;
+    default:
+        return 0;
+    }
+}
+
+static const char *check_file(const TACFileHeader *h, size_t size)
+{
+    if (size < sizeof(*h) || memcmp(h->magic, TAC_FILE_MAGIC, 4) != 0)
+        return "not a TAC file";
+    if (h->version != TAC_FILE_VERSION)
+        return "unsupported TAC version";
+    if (h->byte_order != TAC_FILE_BYTE_ORDER)
+        return "written with a different byte order";
+    if (h->symbol_count > MAX_SYMBOLS)
+        return "too many symbols";
+
+    unsigned long long expected = sizeof(*h) + (unsigned long long)h->instruction_count * sizeof(TACInstruction) +
+                                  (unsigned long long)h->constant_count * sizeof(long long) +
+                                  (unsigned long long)h->symbol_count * sizeof(TACFileSymbol);
+    if (expected != size)
+        return "truncated or oversized";
+
+    char *defined = calloc(h->instruction_count > 0 ? h->instruction_count : 1, 1);
+    if (!defined)
+    {
+        fprintf(stderr, "Memory allocation failed in check_file()\n");
+        exit(1);
+    }
+
+    const char *problem = NULL;
+    const TACInstruction *code = (const TACInstruction *)(h + 1);
+    for (unsigned i = 0; i < h->instruction_count && !problem; i++)
+    {
+        const TACInstruction *ins = &code[i];
+        if (ins->op > TAC_MULHI || !valid_operand(ins->arg1, h, defined, 0) ||
+            !valid_operand(ins->arg2, h, defined, ins->op == TAC_COPY))
+            problem = "malformed instruction";
+        // the backend only encodes constant shift amounts
+        else if (tac_is_shift(ins->op) && (tac_kind(ins->arg2) != TAC_CONST || tac_const_value(ins->arg2) < 0 ||
+                                           tac_const_value(ins->arg2) > 63))
+            problem = "malformed instruction";
+        else if (tac_is_temp(ins->result))
+        {
+            // each temporary is written once, before anything reads it
+            unsigned t = tac_index(ins->result);
+            if (t >= h->instruction_count || defined[t])
+                problem = "malformed instruction";
+            else
+                defined[t] = 1;
+        }
+        else if (!tac_is_var(ins->result) || (unsigned)tac_index(ins->result) >= h->symbol_count)
+            problem = "malformed instruction";
+    }
+
+    free(defined);
+    return problem;
+}
+
+TACInstruction *tac_load_binary(const char *path, int *count)
+{
+    tac_unload();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        printf("Error: cannot open TAC file '%s'.\n", path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(TACFileHeader))
+    {
+        close(fd);
+        printf("Error: TAC file '%s': not a TAC file.\n", path);
+        return NULL;
+    }
+
+    // private and writable: pages are shared with the page cache until something writes them
+    void *p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        printf("Error: cannot map TAC file '%s'.\n", path);
+        return NULL;
+    }
+    mapping = p;
+    mappingSize = st.st_size;
+
+    const TACFileHeader *h = p;
+    const char *problem = check_file(h, mappingSize);
+    if (problem)
+    {
+        printf("Error: TAC file '%s': %s.\n", path, problem);
+        tac_unload();
+        return NULL;
+    }
+
+    TACInstruction *code = (TACInstruction *)(h + 1);
+    const long long *pool = (const long long *)(code + h->instruction_count);
+    const TACFileSymbol *symbols = (const TACFileSymbol *)(pool + h->constant_count);
+
+    // the small tables are copied; the instructions are used where they lie
+    for (unsigned k = 0; k < h->constant_count; k++)
+    {
+        TACOperand o = tac_const(pool[k]);
+        if (tac_kind(o) != TAC_WIDE_CONST || (unsigned)tac_index(o) != k)
+        {
+            printf("Error: TAC file '%s': constant pool out of order.\n", path);
+            tac_unload();
+            return NULL;
+        }
+    }
+
+    symbol_count = h->symbol_count;
+    for (int i = 0; i < symbol_count; i++)
+    {
+        memset(&symbol_table[i], 0, sizeof(symbol_table[i]));
+        memcpy(symbol_table[i].name, symbols[i].name, sizeof(symbols[i].name));
+        memcpy(symbol_table[i].datatype, symbols[i].datatype, sizeof(symbols[i].datatype));
+        symbol_table[i].name[sizeof(symbols[i].name) - 1] = '\0';
+        symbol_table[i].datatype[sizeof(symbols[i].datatype) - 1] = '\0';
+        symbol_table[i].initialized = symbols[i].initialized;
+    }
+
+    *count = h->instruction_count;
+    return code;
+}
+
+void tac_unload(void)
+{
+    if (mapping)
+        munmap(mapping, mappingSize);
+    mapping = NULL;
+    mappingSize = 0;
+}
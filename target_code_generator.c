@@ -1,11 +1,27 @@
 #include "headers/target_code_generator.h"
+#include "headers/dataflow.h"
+#include "headers/superopt.h"
+#include "headers/parallel.h"
+#include "headers/register_allocator.h"
 
-Register registers[MAX_REGISTERS];
+_Thread_local Register registers[MAX_REGISTERS];
 Data data_storage[MAX_DATA];
 int data_count = 0;
 
-int assembly_code_count = 0;
-ASSEMBLY assembly_code[MAX_ASSEMBLY_CODE];
+static int keep_all_data = 0;
+static int use_superopt_table = 1;
+static const long long *initial_values = NULL; // per symbol; NULL while every slot starts at 0
+static int data_slot[MAX_SYMBOLS];              // each variable's position in .data, -1 if it has none
+
+static int plan_msa_layout(int *order); // see MSA PACKING
+
+static int use_register_allocation = 1;
+static int use_memory_forwarding = 1;
+static _Thread_local const RegisterPlan *plan = NULL; // the region being lowered; NULL keeps every variable in memory
+static _Thread_local int first_scratch = 0;           // registers below this one belong to the plan
+
+_Thread_local int assembly_code_count = 0;
+_Thread_local ASSEMBLY assembly_code[MAX_ASSEMBLY_CODE];
 
 void add_assembly_line(const char *format, ...)
 {
@@ -18,6 +34,20 @@ void add_assembly_line(const char *format, ...)
     va_end(args);
 }
 
+// like add_assembly_line(), but puts the line before the one at index at
+static void insert_assembly_line(int at, const char *format, ...)
+{
+    if (assembly_code_count >= MAX_ASSEMBLY_CODE)
+        return;
+
+    memmove(&assembly_code[at + 1], &assembly_code[at], sizeof(ASSEMBLY) * (assembly_code_count - at));
+    assembly_code_count++;
+    va_list args;
+    va_start(args, format);
+    vsprintf(assembly_code[at].assembly, format, args);
+    va_end(args);
+}
+
 void display_assembly_code()
 {
     printf("===== ASSEMBLY CODE =====\n");
@@ -44,7 +74,7 @@ void initialize_registers()
     {
         sprintf(registers[i].name, "r%d", i + 1);
         registers[i].used = 0;
-        registers[i].assigned_temp[0] = '\0';
+        registers[i].assigned_temp = TAC_NO_OPERAND;
 
         // debug
         // printf("%s\n", registers[i].name);
@@ -66,499 +96,1600 @@ void display_data_storage()
     }
 }
 
-int is_in_data_storage(char *data)
-{
-    if (data_count == 0)
-        return 0;
+// === SPILLING ===
+/* When every register is taken, a temporary goes to a slot of the
+   region's stack frame: sd at the spill, ld when it is next read. The
+   frame (MIPS convention: sp-relative, allocated by moving sp down) is
+   only set up for regions that spill. */
+#define MAX_SPILL_SLOTS 4095 // the frame size, 8 bytes a slot, must fit daddiu's signed 16-bit immediate
 
-    for (int i = 0; i < data_count; i++)
+static _Thread_local TACOperand spill_slot[MAX_SPILL_SLOTS]; // the temporary each slot holds
+static _Thread_local int frame_slots = 0;                    // slots the region's frame needs
+static _Thread_local unsigned int fetched = 0;               // registers read by the instruction being lowered
+static _Thread_local const int *temp_last_use = NULL;        // per temporary: last instruction reading it
+
+// the temporary read last leaves its register
+static Register *spill_register()
+{
+    Register *victim = NULL;
+    for (int i = first_scratch; i < MAX_REGISTERS; i++)
     {
-        if (strcmp(data_storage[i].data, data) == 0)
-            return 1;
+        if (!registers[i].used || !tac_is_temp(registers[i].assigned_temp) || (fetched & (1u << i)))
+            continue;
+        if (!victim ||
+            temp_last_use[tac_index(registers[i].assigned_temp)] > temp_last_use[tac_index(victim->assigned_temp)])
+            victim = &registers[i];
+    }
+    if (!victim)
+    {
+        fprintf(stderr, "Out of registers in get_available_register()\n");
+        exit(1);
     }
 
-    return 0;
+    int slot = 0;
+    while (slot < frame_slots && spill_slot[slot] != TAC_NO_OPERAND)
+        slot++;
+    if (slot == MAX_SPILL_SLOTS)
+    {
+        fprintf(stderr, "Stack frame overflow in get_available_register()\n");
+        exit(1);
+    }
+    if (slot == frame_slots)
+        frame_slots++;
+
+    add_assembly_line("sd %s, %d(sp)\n", victim->name, 8 * slot);
+    spill_slot[slot] = victim->assigned_temp;
+    victim->used = 0;
+    victim->assigned_temp = TAC_NO_OPERAND;
+    return victim;
 }
 
 Register *get_available_register()
 {
-    for (int i = 0; i < MAX_REGISTERS; i++)
+    for (int i = first_scratch; i < MAX_REGISTERS; i++)
     {
         if (registers[i].used == 0)
         {
+            registers[i].assigned_temp = TAC_NO_OPERAND;
             return &registers[i];
         }
     }
 
-    return NULL;
+    return spill_register();
 }
 
-int is_tac_temporary(char *tac)
+// reloads a spilled temporary; NULL if it is not in the frame
+static Register *reload_temp(TACOperand temp)
 {
-    // Check prefix
-    if (strncmp(tac, "temp", 4) != 0)
-        return 0;
-
-    // Check that there are digits after "temp"
-    for (int i = 4; tac[i] != '\0'; i++)
+    for (int slot = 0; slot < frame_slots; slot++)
     {
-        if (!isdigit((unsigned char)tac[i]))
-            return 0;
+        if (spill_slot[slot] != temp)
+            continue;
+        Register *reg = get_available_register();
+        add_assembly_line("ld %s, %d(sp)\n", reg->name, 8 * slot);
+        reg->used = 1;
+        reg->assigned_temp = temp;
+        spill_slot[slot] = TAC_NO_OPERAND;
+        return reg;
     }
+    return NULL;
+}
 
-    // Must have at least one digit after "temp"
-    return strlen(tac) > 4;
+// name of the .data label holding a variable operand
+const char *var_name(TACOperand var)
+{
+    return symbol_table[tac_index(var)].name;
 }
 
-Register *find_temp_reg(char *temp)
+Register *find_temp_reg(TACOperand temp)
 {
     for (int i = 0; i < MAX_REGISTERS; i++)
     {
-        if (registers[i].used && strcmp(registers[i].assigned_temp, temp) == 0)
+        if (registers[i].used && registers[i].assigned_temp == temp)
             return &registers[i];
     }
 
     return NULL;
 }
 
+void set_keep_data(int keep)
+{
+    keep_all_data = keep;
+}
+
+void set_register_allocation(int on)
+{
+    use_register_allocation = on;
+}
+
+// variables the optimized code still reads or writes
+static char *referenced_variables()
+{
+    char *referenced = calloc(symbol_count > 0 ? symbol_count : 1, 1);
+    if (!referenced)
+    {
+        fprintf(stderr, "Memory allocation failed in generate_data_section()\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < optimizedCount; i++)
+    {
+        const TACOperand operands[3] = {optimizedCode[i].result, optimizedCode[i].arg1, optimizedCode[i].arg2};
+        for (int k = 0; k < 3; k++)
+            if (tac_is_var(operands[k]))
+                referenced[tac_index(operands[k])] = 1;
+    }
+    return referenced;
+}
+
 void generate_data_section()
 {
     add_assembly_line(".data\n");
 
-    for (int i = 0; i < symbol_count; i++)
+    // symbol table order, unless --msa wants lanes side by side
+    int order[MAX_SYMBOLS];
+    int count = plan_msa_layout(order);
+
+    char *referenced = referenced_variables();
+    int slots = 0;
+    for (int n = 0; n < count; n++)
     {
-        if (is_tac_temporary(symbol_table[i].name))
-        {
+        int i = order[n];
+        data_slot[i] = -1;
+        if (!keep_all_data && !referenced[i])
             continue;
-        }
-        add_assembly_line("%s: .word64 0\n", symbol_table[i].name);
+        data_slot[i] = slots++;
+        add_assembly_line("%s: .word64 %lld\n", symbol_table[i].name, initial_values ? initial_values[i] : 0);
         add_to_data_storage(symbol_table[i].name);
     }
+    free(referenced);
 }
 
-int is_digit(char *value)
+void display_tac_as_comment(TACInstruction ins)
 {
-    // Check for NULL or empty string
-    if (value == NULL || *value == '\0')
-        return 0;
+    char result[64], arg1[64], arg2[64];
+    tac_operand_text(ins.result, result, sizeof(result));
+    tac_operand_text(ins.arg1, arg1, sizeof(arg1));
 
-    // Allow optional leading '-'
-    if (*value == '-')
-        value++;
+    if (ins.op == TAC_COPY)
+        add_assembly_line("; %s = %s\n", result, arg1);
+    else
+        add_assembly_line("; %s = %s %s %s\n", result, arg1, tac_opcode_symbol(ins.op),
+                          tac_operand_text(ins.arg2, arg2, sizeof(arg2)));
+}
 
-    // After '-', there must be at least one digit
-    if (!*value)
-        return 0;
+// === CONSTANTS ===
+/* A constant is built from the top down: its head (the value shifted
+   right by 0, 16, 32 or 48 bits, so that it fits 32 signed bits) goes in
+   with daddiu, ori or lui/ori, then each lower 16-bit chunk is shifted in and
+   ori'd. Zero chunks cost nothing, since the shifts over them merge into
+   one dsll or dsll32; of the four splits the shortest sequence wins.
+
+   A wide constant whose sequence is longer than a load instead gets a
+   .data slot, one per value, and is loaded with ld. */
+#define POOL_LOAD_COST 2 // ld, and the cycle its value arrives late
+
+static int *pool_slot = NULL; // per wide constant: .data slot, -1 if it is built; NULL outside generate_target_code()
+static char pool_prefix[MAX_DATA_LENGTH];
+
+static int fits_16(long long value)
+{
+    return value >= -32768 && value <= 32767;
+}
+
+static int fits_32(long long value)
+{
+    return value >= -2147483648LL && value <= 2147483647LL;
+}
+
+// instructions for value built with a head shifted left by 16 * chunks, -1 if the head is too wide
+static int sequence_length(long long value, int chunks)
+{
+    long long head = value >> (16 * chunks);
+    if (!fits_32(head))
+        return -1;
 
-    // Check that all remaining characters are digits
-    while (*value)
+    int length = fits_16(head) || (head >= 0 && head <= 0xFFFF) || !(head & 0xFFFF) ? 1 : 2;
+    int shifting = 0;
+    for (int chunk = chunks - 1; chunk >= 0; chunk--)
     {
-        if (!isdigit(*value))
-            return 0;
-        value++;
+        shifting = 1;
+        if (((unsigned long long)value >> (16 * chunk)) & 0xFFFF)
+        {
+            length += 2; // the shift so far, then ori
+            shifting = 0;
+        }
+    }
+    return length + shifting;
+}
+
+// the number of chunks below the head of value's shortest sequence
+static int best_split(long long value)
+{
+    int best = 0;
+    for (int chunks = 1; chunks <= 3 && !fits_32(value); chunks++)
+    {
+        int length = sequence_length(value, chunks);
+        if (length >= 0 && (best == 0 || length < sequence_length(value, best)))
+            best = chunks;
     }
+    return best;
+}
 
-    return 1;
+// instructions load_constant() needs for a constant
+static int constant_cost(TACOperand constant)
+{
+    if (pool_slot && tac_kind(constant) == TAC_WIDE_CONST && pool_slot[tac_index(constant)] >= 0)
+        return 1;
+    long long value = tac_const_value(constant);
+    return sequence_length(value, best_split(value));
 }
 
-void display_tac_as_comment(TACInstruction ins)
+static void shift_left(Register *reg, int amount)
 {
-    if (strlen(ins.arg2) == 0)
-        add_assembly_line("; %s = %s\n", ins.result, ins.arg1);
+    if (amount >= 32)
+        add_assembly_line("dsll32 %s, %s, %d\n", reg->name, reg->name, amount - 32);
     else
-        add_assembly_line("; %s = %s %s %s\n", ins.result, ins.arg1, ins.op, ins.arg2);
+        add_assembly_line("dsll %s, %s, %d\n", reg->name, reg->name, amount);
 }
 
-void perform_operation(char *result, char *arg1, char *op, char *arg2, Register *reg1, Register *reg2, Register *reg3, int is_for_temporary)
+// puts a constant in reg
+void load_constant(Register *reg, TACOperand constant)
 {
-    // determine operation
-    if (strcmp(op, "+") == 0)
-        add_assembly_line("daddu %s, %s, %s\n", reg3->name, reg1->name, reg2->name);
-    else if (strcmp(op, "-") == 0)
+    if (pool_slot && tac_kind(constant) == TAC_WIDE_CONST && pool_slot[tac_index(constant)] >= 0)
     {
-        add_assembly_line("dsub %s, %s, %s\n", reg3->name, reg1->name, reg2->name);
+        add_assembly_line("ld %s, %s%d(r0)\n", reg->name, pool_prefix, pool_slot[tac_index(constant)]);
+        return;
+    }
+
+    long long value = tac_const_value(constant);
+    int chunks = best_split(value);
+    long long head = value >> (16 * chunks);
+    if (fits_16(head))
+        add_assembly_line("daddiu %s, r0, %lld\n", reg->name, head);
+    else if (head >= 0 && head <= 0xFFFF)
+        add_assembly_line("ori %s, r0, 0x%llx\n", reg->name, head);
+    else
+    {
+        // lui sign-extends from bit 31, as a 32-bit head needs
+        add_assembly_line("lui %s, 0x%llx\n", reg->name, ((unsigned long long)head >> 16) & 0xFFFF);
+        if (head & 0xFFFF)
+            add_assembly_line("ori %s, %s, 0x%llx\n", reg->name, reg->name, (unsigned long long)head & 0xFFFF);
     }
-    else if (strcmp(op, "*") == 0)
+
+    int shift = 0;
+    for (int chunk = chunks - 1; chunk >= 0; chunk--)
     {
-        add_assembly_line("dmult %s, %s\n", reg1->name, reg2->name);
-        add_assembly_line("mflo %s\n", reg3->name);
+        shift += 16;
+        unsigned long long bits = ((unsigned long long)value >> (16 * chunk)) & 0xFFFF;
+        if (!bits)
+            continue;
+        shift_left(reg, shift);
+        add_assembly_line("ori %s, %s, 0x%llx\n", reg->name, reg->name, bits);
+        shift = 0;
     }
-    else if (strcmp(op, "/") == 0)
+    if (shift)
+        shift_left(reg, shift);
+}
+
+// a label prefix no variable name starts with
+static void choose_pool_prefix()
+{
+    strcpy(pool_prefix, "_k");
+    for (int i = 0; i < symbol_count && strlen(pool_prefix) < MAX_DATA_LENGTH - 8; i++)
     {
-        add_assembly_line("ddiv %s, %s\n", reg1->name, reg2->name);
-        add_assembly_line("mflo %s\n", reg3->name);
+        if (strncmp(symbol_table[i].name, pool_prefix, strlen(pool_prefix)) != 0)
+            continue;
+        strcat(pool_prefix, "_");
+        i = -1;
     }
+}
 
-    if (!is_for_temporary)
+// .data slots for the wide constants the code reads that are cheaper to load than to build
+static void generate_constant_pool()
+{
+    int wide_count = 0;
+    tac_constant_pool(&wide_count);
+    pool_slot = malloc(sizeof(int) * (wide_count > 0 ? wide_count : 1));
+    if (!pool_slot)
     {
-        add_assembly_line("sd %s, %s(r0)\n", reg3->name, result);
+        fprintf(stderr, "Memory allocation failed in generate_constant_pool()\n");
+        exit(1);
+    }
+    for (int k = 0; k < wide_count; k++)
+        pool_slot[k] = -1;
+    choose_pool_prefix();
 
-        // Free only the registers used in this operation so temps in other registers survive.
-        if (reg1)
+    int slots = 0;
+    for (int i = 0; i < optimizedCount; i++)
+    {
+        const TACOperand args[2] = {optimizedCode[i].arg1, optimizedCode[i].arg2};
+        for (int k = 0; k < 2; k++)
         {
-            reg1->used = 0;
-            reg1->assigned_temp[0] = '\0';
+            if (tac_kind(args[k]) != TAC_WIDE_CONST || pool_slot[tac_index(args[k])] >= 0 ||
+                slots == MAX_CONSTANT_POOL || constant_cost(args[k]) <= POOL_LOAD_COST)
+                continue;
+            pool_slot[tac_index(args[k])] = slots;
+            add_assembly_line("%s%d: .word64 %lld\n", pool_prefix, slots++, tac_const_value(args[k]));
         }
-        if (reg2)
+    }
+}
+
+// the register the plan gives an operand for the region, NULL if it has none
+static Register *planned_register(TACOperand operand)
+{
+    if (!plan)
+        return NULL;
+    int id = dataflow_operand_id(&plan->ids, operand);
+    return id >= 0 && plan->reg[id] >= 0 ? &registers[plan->reg[id]] : NULL;
+}
+
+/* The register to read an operand from: a temporary's own, a resident
+   variable's (loaded on its first read), otherwise a fresh register the
+   variable or constant is loaded into. */
+Register *operand_register(TACOperand operand)
+{
+    Register *reg;
+    if (tac_is_temp(operand))
+    {
+        reg = find_temp_reg(operand);
+        if (!reg)
+            reg = reload_temp(operand);
+    }
+    else if ((reg = planned_register(operand)))
+    {
+        if (reg->assigned_temp != operand)
         {
-            reg2->used = 0;
-            reg2->assigned_temp[0] = '\0';
+            add_assembly_line("ld %s, %s(r0)\n", reg->name, var_name(operand));
+            reg->used = 1;
+            reg->assigned_temp = operand;
         }
-        if (reg3)
+    }
+    else
+    {
+        reg = get_available_register();
+        reg->used = 1;
+        if (tac_is_var(operand))
+            add_assembly_line("ld %s, %s(r0)\n", reg->name, var_name(operand));
+        else
+            load_constant(reg, operand);
+    }
+
+    // the instruction still needs it, so it cannot be spilled for the instruction's other registers
+    if (reg)
+        fetched |= 1u << (reg - registers);
+    return reg;
+}
+
+// the register to compute result into; finish_target() says where it ends up
+static Register *target_register(TACOperand result)
+{
+    Register *reg = planned_register(result);
+    if (!reg && tac_is_temp(result))
+        reg = find_temp_reg(result);
+    if (!reg)
+        reg = get_available_register();
+    reg->used = 1;
+    return reg;
+}
+
+// stores a resident variable the region wrote, before its register moves on
+static void write_back(Register *reg)
+{
+    int id = dataflow_operand_id(&plan->ids, reg->assigned_temp);
+    if (tac_is_var(reg->assigned_temp) && plan->dirty[id])
+        add_assembly_line("sd %s, %s(r0)\n", reg->name, var_name(reg->assigned_temp));
+}
+
+// a variable without a register goes straight to memory; anything else keeps reg
+static void finish_target(TACOperand result, Register *reg)
+{
+    if (tac_is_var(result) && !planned_register(result))
+    {
+        add_assembly_line("sd %s, %s(r0)\n", reg->name, var_name(result));
+        reg->used = 0;
+        reg->assigned_temp = TAC_NO_OPERAND;
+    }
+    else
+        reg->assigned_temp = result;
+}
+
+// frees a register unless it holds a temporary or a resident variable
+void release_scratch(Register *reg)
+{
+    if (reg && reg->assigned_temp == TAC_NO_OPERAND)
+        reg->used = 0;
+}
+
+void perform_copy(TACInstruction ins)
+{
+    // a resident target is loaded directly from a constant or a variable in memory
+    Register *dst = planned_register(ins.result);
+    if (dst && (tac_is_const(ins.arg1) || (tac_is_var(ins.arg1) && !planned_register(ins.arg1))))
+    {
+        if (tac_is_var(ins.arg1))
+            add_assembly_line("ld %s, %s(r0)\n", dst->name, var_name(ins.arg1));
+        else
+            load_constant(dst, ins.arg1);
+        dst->used = 1;
+        dst->assigned_temp = ins.result;
+        return;
+    }
+
+    Register *src = operand_register(ins.arg1);
+    if (!dst && tac_is_var(ins.result))
+    {
+        add_assembly_line("sd %s, %s(r0)\n", src->name, var_name(ins.result));
+        release_scratch(src);
+        return;
+    }
+
+    // a fresh register simply becomes the temporary
+    if (!dst && src->assigned_temp == TAC_NO_OPERAND)
+        dst = src;
+    else
+    {
+        if (!dst)
+            dst = target_register(ins.result);
+        if (dst != src)
+            add_assembly_line("daddu %s, %s, r0\n", dst->name, src->name);
+        // a variable ending here hands its register to the target
+        else if (src->assigned_temp != ins.result)
+            write_back(src);
+        release_scratch(src);
+    }
+    dst->used = 1;
+    dst->assigned_temp = ins.result;
+}
+
+// frees registers and frame slots whose temporaries are not read again after instruction i
+void release_dead_temps(const DataflowResult *live, int i)
+{
+    for (int slot = 0; slot < frame_slots; slot++)
+        if (spill_slot[slot] != TAC_NO_OPERAND &&
+            !bitset_test(&live->out[i], dataflow_operand_id(&live->ids, spill_slot[slot])))
+            spill_slot[slot] = TAC_NO_OPERAND;
+
+    for (int r = 0; r < MAX_REGISTERS; r++)
+    {
+        if (!registers[r].used || !tac_is_temp(registers[r].assigned_temp))
+            continue;
+
+        int id = dataflow_operand_id(&live->ids, registers[r].assigned_temp);
+        if (!bitset_test(&live->out[i], id))
         {
-            reg3->used = 0;
-            reg3->assigned_temp[0] = '\0';
+            registers[r].used = 0;
+            registers[r].assigned_temp = TAC_NO_OPERAND;
         }
     }
+}
 
-    else
+// ends the plan's intervals that close at instruction i, storing the variables the region wrote
+static void release_ended_intervals(int i)
+{
+    for (int r = 0; plan && r < REGALLOC_REGISTERS; r++)
     {
-        strcpy(reg3->assigned_temp, result);
-        reg1->used = 0;
-        reg2->used = 0;
+        Register *reg = &registers[r];
+        int id = dataflow_operand_id(&plan->ids, reg->assigned_temp);
+        if (!reg->used || id < 0 || plan->end[id] > i)
+            continue;
+        write_back(reg);
+        reg->used = 0;
+        reg->assigned_temp = TAC_NO_OPERAND;
     }
 }
 
-void generate_code_section()
+// === INSTRUCTION SELECTION ===
+/* Each TAC opcode has a row of instruction forms that can compute it,
+   giving the kind of operand each form takes and the instructions the
+   form itself emits. select_form() takes the cheapest form the operands
+   fit, counting what it costs to bring an operand into a register, so a
+   new form is one more entry in instruction_forms. */
+typedef enum
 {
-    add_assembly_line("\n.code\n");
+    OPERAND_NONE,      // the instruction has no such operand
+    OPERAND_REGISTER,  // anything, loaded into a register unless it is in one
+    OPERAND_SHIFT,     // a constant shift amount, 0 .. 63
+    OPERAND_IMMEDIATE, // a constant that fits the signed 16-bit immediate
+    OPERAND_NEGATED    // a constant whose negation does, for subtracting with daddiu
+} OperandKind;
+
+typedef struct InstructionForm InstructionForm;
+struct InstructionForm
+{
+    OperandKind arg1, arg2;
+    int cost; // instructions the form emits once its operands are in place
+    const char *mnemonic;
+    const char *move; // for dmult/ddiv: mflo or mfhi, taking the result out of lo/hi
+    void (*emit)(TACInstruction ins, const InstructionForm *form);
+};
+
+// instructions operand_register() emits for an operand
+static int load_cost(TACOperand operand)
+{
+    if (tac_is_const(operand))
+        return constant_cost(operand);
+    if (tac_is_temp(operand))
+        return find_temp_reg(operand) ? 0 : 1; // otherwise reloaded from its spill slot
 
-    for (int i = 0; i < optimizedCount; i++)
+    Register *reg = planned_register(operand);
+    return reg && reg->assigned_temp == operand ? 0 : 1;
+}
+
+// what it costs to pass operand as kind, -1 if it cannot be
+static int operand_cost(TACOperand operand, OperandKind kind)
+{
+    if (kind == OPERAND_NONE)
+        return operand == TAC_NO_OPERAND ? 0 : -1;
+    if (operand == TAC_NO_OPERAND)
+        return -1;
+    if (kind == OPERAND_REGISTER)
+        return load_cost(operand);
+
+    if (!tac_is_const(operand))
+        return -1;
+    long long value = tac_const_value(operand);
+    if (kind == OPERAND_SHIFT)
+        return value >= 0 && value <= 63 ? 0 : -1;
+    return fits_16(kind == OPERAND_NEGATED ? -value : value) ? 0 : -1;
+}
+
+static void emit_copy(TACInstruction ins, const InstructionForm *form)
+{
+    (void)form;
+    perform_copy(ins);
+}
+
+// result = arg1 op arg2, all three in registers
+static void emit_register_form(TACInstruction ins, const InstructionForm *form)
+{
+    Register *reg1 = operand_register(ins.arg1);
+    Register *reg2 = operand_register(ins.arg2);
+    Register *reg3 = target_register(ins.result);
+
+    if (form->move)
     {
-        TACInstruction ins = optimizedCode[i];
-        display_tac_as_comment(ins);
+        add_assembly_line("%s %s, %s\n", form->mnemonic, reg1->name, reg2->name);
+        add_assembly_line("%s %s\n", form->move, reg3->name);
+    }
+    else
+        add_assembly_line("%s %s, %s, %s\n", form->mnemonic, reg3->name, reg1->name, reg2->name);
 
-        // case 1 : assignment only
-        if (strlen(ins.arg2) == 0)
+    finish_target(ins.result, reg3);
+
+    // operands held in temporaries stay until liveness says they are dead
+    release_scratch(reg1);
+    release_scratch(reg2);
+}
+
+// shifts take their amount as an immediate: dsll/dsra/dsrl for 0-31, the *32 forms above
+static void emit_shift_form(TACInstruction ins, const InstructionForm *form)
+{
+    Register *src = operand_register(ins.arg1);
+    Register *dst = target_register(ins.result);
+
+    int amount = (int)tac_const_value(ins.arg2);
+    if (amount >= 32)
+        add_assembly_line("%s32 %s, %s, %d\n", form->mnemonic, dst->name, src->name, amount - 32);
+    else
+        add_assembly_line("%s %s, %s, %d\n", form->mnemonic, dst->name, src->name, amount);
+
+    release_scratch(src);
+    finish_target(ins.result, dst);
+}
+
+// result = register operand + constant, the constant carried in the instruction
+static void emit_immediate_form(TACInstruction ins, const InstructionForm *form)
+{
+    int constant_first = form->arg1 != OPERAND_REGISTER;
+    OperandKind kind = constant_first ? form->arg1 : form->arg2;
+    long long value = tac_const_value(constant_first ? ins.arg1 : ins.arg2);
+
+    Register *src = operand_register(constant_first ? ins.arg2 : ins.arg1);
+    Register *dst = target_register(ins.result);
+    add_assembly_line("%s %s, %s, %lld\n", form->mnemonic, dst->name, src->name,
+                      kind == OPERAND_NEGATED ? -value : value);
+
+    release_scratch(src);
+    finish_target(ins.result, dst);
+}
+
+static const InstructionForm copy_forms[] = {{OPERAND_REGISTER, OPERAND_NONE, 0, NULL, NULL, emit_copy}};
+static const InstructionForm add_forms[] = {
+    {OPERAND_REGISTER, OPERAND_REGISTER, 1, "daddu", NULL, emit_register_form},
+    {OPERAND_REGISTER, OPERAND_IMMEDIATE, 1, "daddiu", NULL, emit_immediate_form},
+    {OPERAND_IMMEDIATE, OPERAND_REGISTER, 1, "daddiu", NULL, emit_immediate_form}};
+static const InstructionForm sub_forms[] = {
+    {OPERAND_REGISTER, OPERAND_REGISTER, 1, "dsubu", NULL, emit_register_form},
+    {OPERAND_REGISTER, OPERAND_NEGATED, 1, "daddiu", NULL, emit_immediate_form}};
+static const InstructionForm mul_forms[] = {
+    {OPERAND_REGISTER, OPERAND_REGISTER, 2, "dmult", "mflo", emit_register_form}};
+static const InstructionForm div_forms[] = {
+    {OPERAND_REGISTER, OPERAND_REGISTER, 2, "ddiv", "mflo", emit_register_form}};
+static const InstructionForm mulhi_forms[] = {
+    {OPERAND_REGISTER, OPERAND_REGISTER, 2, "dmult", "mfhi", emit_register_form}};
+static const InstructionForm shl_forms[] = {{OPERAND_REGISTER, OPERAND_SHIFT, 1, "dsll", NULL, emit_shift_form}};
+static const InstructionForm sar_forms[] = {{OPERAND_REGISTER, OPERAND_SHIFT, 1, "dsra", NULL, emit_shift_form}};
+static const InstructionForm shr_forms[] = {{OPERAND_REGISTER, OPERAND_SHIFT, 1, "dsrl", NULL, emit_shift_form}};
+
+#define FORMS(forms) {forms, sizeof(forms) / sizeof(forms[0])}
+static const struct
+{
+    const InstructionForm *form;
+    int count;
+} instruction_forms[] = {
+    [TAC_COPY] = FORMS(copy_forms), [TAC_ADD] = FORMS(add_forms), [TAC_SUB] = FORMS(sub_forms),
+    [TAC_MUL] = FORMS(mul_forms),   [TAC_DIV] = FORMS(div_forms), [TAC_SHL] = FORMS(shl_forms),
+    [TAC_SAR] = FORMS(sar_forms),   [TAC_SHR] = FORMS(shr_forms), [TAC_MULHI] = FORMS(mulhi_forms),
+};
+#undef FORMS
+
+// the cheapest form of ins's opcode its operands fit; the earlier row wins a tie
+static const InstructionForm *select_form(TACInstruction ins)
+{
+    const InstructionForm *best = NULL;
+    int best_cost = 0;
+    for (int f = 0; f < instruction_forms[ins.op].count; f++)
+    {
+        const InstructionForm *form = &instruction_forms[ins.op].form[f];
+        int cost1 = operand_cost(ins.arg1, form->arg1);
+        int cost2 = operand_cost(ins.arg2, form->arg2);
+        if (cost1 < 0 || cost2 < 0)
+            continue;
+        int cost = form->cost + cost1 + cost2;
+        if (!best || cost < best_cost)
         {
-            // case 1 : variable = constant (for constant: check if positive or negative)
-            if (is_in_data_storage(ins.result) &&
-                (isdigit(ins.arg1[0]) || (ins.arg1[0] == '-' && isdigit(ins.arg1[1]))))
-            {
-                Register *reg = get_available_register();
-                reg->used = 1;
+            best = form;
+            best_cost = cost;
+        }
+    }
 
-                add_assembly_line("daddiu %s, r0, %s\n", reg->name, ins.arg1);
-                add_assembly_line("sd %s, %s(r0)\n", reg->name, ins.result);
+    if (!best)
+    {
+        fprintf(stderr, "No instruction form for '%s' in select_form()\n", tac_opcode_symbol(ins.op));
+        exit(1);
+    }
+    return best;
+}
 
-                reg->used = 0;
-            }
-            // case 2 : variable = variable
-            else if (is_in_data_storage(ins.result) && is_in_data_storage(ins.arg1))
-            {
-                Register *arg1_val_reg = get_available_register();
-                arg1_val_reg->used = 1;
+// === SUPEROPTIMIZER TABLE ===
+void set_superoptimizer(int on)
+{
+    use_superopt_table = on;
+}
 
-                add_assembly_line("ld %s, %s(r0)\n", arg1_val_reg->name, ins.arg1);
-                add_assembly_line("sd %s, %s(r0)\n", arg1_val_reg->name, ins.result);
+typedef struct
+{
+    const SuperoptEntry *entry; // set on the root of a matched tree
+    int skip;                   // computed together with a later root
+    int root;                   // with skip: that root
+    TACOperand input[SUPEROPT_MAX_INPUTS];
+} ShapeMatch;
 
-                arg1_val_reg->used = 0;
-            }
-            // case 3 : variable = temp
-            else if (is_in_data_storage(ins.result) && is_tac_temporary(ins.arg1))
-            {
-                // find register temp
-                Register *temp_reg = find_temp_reg(ins.arg1);
+typedef struct
+{
+    const TACInstruction *code;
+    const int *def_at;    // per temporary: defining instruction, -1 if none or several
+    const char *internal; // per instruction: feeds the next node of its tree
+    SuperoptTree tree;
+    TACOperand vars[SUPEROPT_MAX_INPUTS + 1];
+    int members[SUPEROPT_MAX_OPS];
+    int member_count;
+} ShapeBuilder;
+
+static int shape_op(TACOpcode op)
+{
+    return op == TAC_ADD || op == TAC_SUB || op == TAC_MUL || tac_is_shift(op);
+}
 
-                add_assembly_line("sd %s, %s(r0)\n", temp_reg->name, ins.result);
-            }
-            // case 4 : temp = variable
-            else if (is_tac_temporary(ins.result) && is_in_data_storage(ins.arg1))
-            {
-                Register *var_reg = get_available_register();
-                var_reg->used = 1;
+static int shape_leaf(ShapeBuilder *b, TACOperand o)
+{
+    if (b->tree.count == (int)(sizeof(b->tree.node) / sizeof(b->tree.node[0])))
+        return -1;
+    int n = b->tree.count++;
+    SuperoptNode *node = &b->tree.node[n];
+    memset(node, 0, sizeof(*node));
 
-                add_assembly_line("ld %s, %s(r0)\n", var_reg->name, ins.arg1);
-                // the available register now becomes the temporary
-                strcpy(var_reg->assigned_temp, ins.result);
-            }
-            // case 5 : temp = constant
-            else if (is_tac_temporary(ins.result) && is_digit(ins.arg1))
-            {
-                Register *temp_reg = get_available_register();
-                temp_reg->used = 1;
-                strcpy(temp_reg->assigned_temp, ins.result);
+    if (tac_is_const(o))
+    {
+        node->var = -1;
+        node->value = tac_const_value(o);
+        return n;
+    }
+    if (!tac_is_var(o))
+        return -1; // a temporary computed outside the tree
+
+    for (node->var = 0; node->var < b->tree.vars; node->var++)
+        if (b->vars[node->var] == o)
+            return n;
+    if (b->tree.vars == SUPEROPT_MAX_INPUTS)
+        return -1;
+    b->vars[b->tree.vars++] = o;
+    return n;
+}
+
+// the tree under instruction i as shape nodes; -1 if it does not fit a shape
+static int shape_node(ShapeBuilder *b, int i)
+{
+    const TACInstruction *ins = &b->code[i];
+    if (b->member_count == SUPEROPT_MAX_OPS || b->tree.count == (int)(sizeof(b->tree.node) / sizeof(b->tree.node[0])))
+        return -1;
+    b->members[b->member_count++] = i;
+    int n = b->tree.count++;
+
+    int children[2];
+    TACOperand args[2] = {ins->arg1, ins->arg2};
+    for (int k = 0; k < 2; k++)
+    {
+        int d = tac_is_temp(args[k]) ? b->def_at[tac_index(args[k])] : -1;
+        children[k] = d >= 0 && b->internal[d] ? shape_node(b, d) : shape_leaf(b, args[k]);
+        if (children[k] < 0)
+            return -1;
+    }
+
+    SuperoptNode *node = &b->tree.node[n];
+    snprintf(node->op, sizeof(node->op), "%s", tac_opcode_symbol(ins->op));
+    node->var = -1;
+    node->left = children[0];
+    node->right = children[1];
+    return n;
+}
 
-                add_assembly_line("daddiu %s, r0, %s\n", temp_reg->name, ins.arg1);
+/* Finds the expression trees the superoptimizer has a cheaper sequence
+   for. A tree is a chain of arithmetic instructions whose temporaries are
+   each read once, by the next node; its leaves are constants and at most
+   two variables that nothing writes between the tree's first node and its
+   root, where they are loaded. */
+static ShapeMatch *match_shapes(const TACInstruction *code, int count)
+{
+    if (!use_superopt_table || count == 0)
+        return NULL;
+
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    int temps = ids.temp_count;
+    int *def_at = malloc(sizeof(int) * (temps + 1));
+    int *uses = calloc(temps + 1, sizeof(int));
+    int *consumer = calloc(temps + 1, sizeof(int));
+    char *internal = calloc(count, 1);
+    ShapeMatch *matches = calloc(count, sizeof(ShapeMatch));
+    if (!def_at || !uses || !consumer || !internal || !matches)
+    {
+        fprintf(stderr, "Memory allocation failed in generate_code_section()\n");
+        exit(1);
+    }
+
+    for (int k = 0; k < temps; k++)
+        def_at[k] = -1;
+    for (int i = 0; i < count; i++)
+    {
+        if (tac_is_temp(code[i].result))
+        {
+            int k = tac_index(code[i].result);
+            def_at[k] = def_at[k] == -1 ? i : -2;
+        }
+        TACOperand args[2] = {code[i].arg1, code[i].arg2};
+        for (int a = 0; a < 2; a++)
+            if (tac_is_temp(args[a]))
+            {
+                uses[tac_index(args[a])]++;
+                consumer[tac_index(args[a])] = i;
             }
-            // case 6 : temp = temp
-            else if (is_tac_temporary(ins.result) && is_tac_temporary(ins.arg1))
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (!shape_op(code[i].op) || !tac_is_temp(code[i].result))
+            continue;
+        int k = tac_index(code[i].result);
+        internal[i] = def_at[k] == i && uses[k] == 1 && shape_op(code[consumer[k]].op);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!shape_op(code[i].op) || internal[i])
+            continue;
+
+        ShapeBuilder b;
+        b.code = code;
+        b.def_at = def_at;
+        b.internal = internal;
+        b.tree.count = b.tree.vars = 0;
+        b.member_count = 0;
+        b.tree.root = shape_node(&b, i);
+        if (b.tree.root < 0)
+            continue;
+
+        int first = i;
+        for (int m = 0; m < b.member_count; m++)
+            if (b.members[m] < first)
+                first = b.members[m];
+        int clobbered = 0;
+        for (int j = first; j < i && !clobbered; j++)
+            for (int v = 0; v < b.tree.vars; v++)
+                clobbered |= code[j].result == b.vars[v];
+
+        char key[SUPEROPT_MAX_SHAPE];
+        int rename[SUPEROPT_MAX_INPUTS];
+        if (clobbered || !superopt_shape(&b.tree, key, sizeof(key), rename))
+            continue;
+        const SuperoptEntry *entry = superopt_lookup(superopt_table, superopt_table_size, key);
+        if (!entry)
+            continue;
+
+        matches[i].entry = entry;
+        for (int v = 0; v < b.tree.vars; v++)
+            matches[i].input[rename[v]] = b.vars[v];
+        for (int m = 0; m < b.member_count; m++)
+            if (b.members[m] != i)
             {
-                // Find both temp registers
-                Register *temp_res = find_temp_reg(ins.result);
-                Register *temp_arg1 = find_temp_reg(ins.arg1);
-
-                // If result temp does not yet have a register, allocate one
-                if (!temp_res)
-                {
-                    temp_res = get_available_register();
-                    temp_res->used = 1;
-                    strcpy(temp_res->assigned_temp, ins.result);
-                }
-
-                // If argument temp does not exist (shouldn’t normally happen, but safe to check)
-                if (!temp_arg1)
-                {
-                    temp_arg1 = get_available_register();
-                    temp_arg1->used = 1;
-                    strcpy(temp_arg1->assigned_temp, ins.arg1);
-                }
-
-                // Move value from arg1 temp into result temp
-                add_assembly_line("daddu %s, %s, r0\n", temp_res->name, temp_arg1->name);
+                matches[b.members[m]].skip = 1;
+                matches[b.members[m]].root = i;
             }
+    }
+
+    free(def_at);
+    free(uses);
+    free(consumer);
+    free(internal);
+    return matches;
+}
+
+// the table's sequence for a matched tree, in place of its instructions
+static void emit_shape(const ShapeMatch *match, TACInstruction ins)
+{
+    const SuperoptEntry *e = match->entry;
+    Register *value[2 + SUPEROPT_MAX_STEPS] = {NULL};
+    static const char *mnemonics[] = {[SO_DADDU] = "daddu", [SO_DSUBU] = "dsubu", [SO_DSLL] = "dsll",
+                                      [SO_DSRA] = "dsra",   [SO_DSRL] = "dsrl",   [SO_DADDIU] = "daddiu"};
+
+    add_assembly_line("; superoptimizer: %s\n", e->shape);
+    // no steps: the tree's value is r0 or one of its inputs
+    if (e->steps == 0)
+    {
+        TACInstruction copy = {TAC_COPY, ins.result, e->result < 0 ? tac_const(0) : match->input[e->result],
+                               TAC_NO_OPERAND};
+        perform_copy(copy);
+        return;
+    }
+    for (int k = 0; k < e->steps; k++)
+    {
+        const SuperoptStep *st = &e->step[k];
+        int srcs[2] = {st->src1, st->op <= SO_DMULT ? st->src2 : -1};
+        for (int s = 0; s < 2; s++)
+            if (srcs[s] >= 0 && srcs[s] < SUPEROPT_MAX_INPUTS && !value[srcs[s]])
+                value[srcs[s]] = operand_register(match->input[srcs[s]]);
+
+        const char *a = st->src1 < 0 ? "r0" : value[st->src1]->name;
+        Register *dst;
+        if (k == e->steps - 1)
+            dst = target_register(ins.result);
+        else
+        {
+            dst = get_available_register();
+            dst->used = 1;
+        }
+        value[2 + k] = dst;
+
+        if (st->op == SO_DMULT)
+        {
+            add_assembly_line("dmult %s, %s\n", a, st->src2 < 0 ? "r0" : value[st->src2]->name);
+            add_assembly_line("mflo %s\n", dst->name);
         }
-        // case 2 : assignment + operation
+        else if (st->op == SO_DADDU || st->op == SO_DSUBU)
+            add_assembly_line("%s %s, %s, %s\n", mnemonics[st->op], dst->name, a,
+                              st->src2 < 0 ? "r0" : value[st->src2]->name);
+        else if (st->op == SO_DADDIU)
+            add_assembly_line("daddiu %s, %s, %d\n", dst->name, a, st->imm);
+        else if (st->imm >= 32)
+            add_assembly_line("%s32 %s, %s, %d\n", mnemonics[st->op], dst->name, a, st->imm - 32);
         else
+            add_assembly_line("%s %s, %s, %d\n", mnemonics[st->op], dst->name, a, st->imm);
+    }
+
+    Register *result = value[e->result];
+    for (int v = 0; v < 1 + e->steps; v++)
+        release_scratch(value[v]);
+    finish_target(ins.result, result);
+}
+
+// === MSA PACKING ===
+/* With --msa, two instructions doing the same operation on variables
+   that sit side by side in .data (the first instruction's operands one
+   doubleword before the second's) are computed together: ld.d loads
+   both lanes of an operand, one vector instruction does the work, and
+   st.d or copy_s.d puts the lanes back. The data section is laid out to
+   make such pairs. */
+#define MSA_WINDOW 8     // how far ahead an instruction looks for its partner
+#define MSA_MAX_SLOT 511 // ld.d and st.d reach 511 doublewords past r0
+
+static int use_msa = 0;
+static int next_in_layout[MAX_SYMBOLS]; // while laying out .data: the variable that must follow, -1 if none
+static int prev_in_layout[MAX_SYMBOLS];
+
+void set_msa(int on)
+{
+    use_msa = on;
+}
+
+static int packable_op(TACOpcode op)
+{
+    return op == TAC_ADD || op == TAC_SUB || op == TAC_MUL || tac_is_shift(op);
+}
+
+/* How b can join an earlier a in one vector instruction: 1 if a can
+   move down to b (nothing after a up to b reads a's result, nothing
+   between them writes a's operands or result), 2 if b can move up to a
+   (b does not read a's result, nothing between them reads or writes b's
+   result or writes b's operands), 0 if neither or if they are not the
+   same operation on different variables (shifts by the same amount).
+   Where the operands live is checked separately. */
+static int can_pack(const TACInstruction *code, int a, int b)
+{
+    const TACInstruction *x = &code[a], *y = &code[b];
+    if (x->op != y->op || !packable_op(x->op) || !tac_is_var(x->arg1) || !tac_is_var(y->arg1) || x->arg1 == y->arg1)
+        return 0;
+    if (tac_is_shift(x->op))
+    {
+        if (!tac_is_const(x->arg2) || !tac_is_const(y->arg2) || tac_const_value(x->arg2) != tac_const_value(y->arg2) ||
+            tac_const_value(x->arg2) < 0 || tac_const_value(x->arg2) > 63)
+            return 0;
+    }
+    else if (!tac_is_var(x->arg2) || !tac_is_var(y->arg2) || x->arg2 == y->arg2)
+        return 0;
+
+    int down = 1;
+    int up = y->arg1 != x->result && y->arg2 != x->result;
+    for (int k = a + 1; k <= b; k++)
+    {
+        const TACInstruction *c = &code[k];
+        if (c->arg1 == x->result || c->arg2 == x->result)
+            down = 0;
+        if (k == b)
+            break;
+        if (c->result == x->result || c->result == x->arg1 || c->result == x->arg2)
+            down = 0;
+        if (c->arg1 == y->result || c->arg2 == y->result || c->result == y->result || c->result == y->arg1 ||
+            c->result == y->arg2)
+            up = 0;
+    }
+    return down ? 1 : up ? 2 : 0;
+}
+
+// whether second is the doubleword after first in .data, within ld.d's reach
+static int adjacent(TACOperand first, TACOperand second)
+{
+    int slot = data_slot[tac_index(first)];
+    return slot >= 0 && slot <= MSA_MAX_SLOT && data_slot[tac_index(second)] == slot + 1;
+}
+
+static int stores_together(const TACInstruction *x, const TACInstruction *y)
+{
+    return tac_is_var(x->result) && tac_is_var(y->result) && adjacent(x->result, y->result);
+}
+
+// the layout is fixed: the lanes' operands must already be side by side
+static int lanes_fit(const TACInstruction *x, const TACInstruction *y)
+{
+    if (!adjacent(x->arg1, y->arg1))
+        return 0;
+    // a shift has one vector operand, so only a single st.d makes it pay
+    if (tac_is_shift(x->op))
+        return stores_together(x, y);
+    return adjacent(x->arg2, y->arg2);
+}
+
+// whether following the layout chain from 'from' reaches 'to'
+static int reaches(int from, int to)
+{
+    for (int v = from; v >= 0; v = next_in_layout[v])
+        if (v == to)
+            return 1;
+    return 0;
+}
+
+// makes second follow first in .data; 0 if that conflicts with earlier links
+static int link_slots(TACOperand first, TACOperand second)
+{
+    int a = tac_index(first), b = tac_index(second);
+    if (next_in_layout[a] == b)
+        return 1;
+    if (next_in_layout[a] != -1 || prev_in_layout[b] != -1 || reaches(b, a))
+        return 0;
+    next_in_layout[a] = b;
+    prev_in_layout[b] = a;
+    return 1;
+}
+
+static void unlink_slots(TACOperand first)
+{
+    int a = tac_index(first);
+    prev_in_layout[next_in_layout[a]] = -1;
+    next_in_layout[a] = -1;
+}
+
+// the layout is still open: link the lanes' operands (and, if possible, results) together
+static int link_lanes(const TACInstruction *x, const TACInstruction *y)
+{
+    int linked = next_in_layout[tac_index(x->arg1)] == tac_index(y->arg1);
+    if (!link_slots(x->arg1, y->arg1))
+        return 0;
+
+    int results = tac_is_var(x->result) && tac_is_var(y->result) && x->result != y->result;
+    int second = tac_is_shift(x->op) ? results && link_slots(x->result, y->result) : link_slots(x->arg2, y->arg2);
+    if (!second)
+    {
+        if (!linked)
+            unlink_slots(x->arg1);
+        return 0;
+    }
+    if (results && !tac_is_shift(x->op))
+        link_slots(x->result, y->result);
+    return 1;
+}
+
+typedef struct
+{
+    int partner; // the other instruction of the pair, -1 if unpaired
+    int emit;    // the vector code goes here rather than at the partner
+} MsaPair;
+
+/* Pairs up instructions for one vector instruction each; NULL without
+   --msa. Each instruction takes the first partner within MSA_WINDOW that
+   can_pack() and fits allow. Trees the superoptimizer handles are left
+   alone. */
+static MsaPair *pair_instructions(const TACInstruction *code, int count, const ShapeMatch *shapes,
+                                  int (*fits)(const TACInstruction *, const TACInstruction *))
+{
+    if (!use_msa || count == 0)
+        return NULL;
+
+    MsaPair *pairs = malloc(sizeof(MsaPair) * count);
+    if (!pairs)
+    {
+        fprintf(stderr, "Memory allocation failed in pair_instructions()\n");
+        exit(1);
+    }
+    for (int i = 0; i < count; i++)
+        pairs[i] = (MsaPair){-1, 0};
+
+    for (int i = 0; i < count; i++)
+    {
+        if (pairs[i].partner >= 0 || (shapes && (shapes[i].entry || shapes[i].skip)))
+            continue;
+        for (int j = i + 1; j < count && j <= i + MSA_WINDOW; j++)
         {
-            Register *reg1 = get_available_register();
-            reg1->used = 1;
-            Register *reg2 = get_available_register();
-            reg2->used = 1;
-            Register *reg3 = get_available_register();
-            reg3->used = 1;
-
-            // variable = constant op constant
-            if (is_in_data_storage(ins.result) && is_digit(ins.arg1) && is_digit(ins.arg2))
+            if (pairs[j].partner >= 0 || (shapes && (shapes[j].entry || shapes[j].skip)))
+                continue;
+            int how = can_pack(code, i, j);
+            if (how && fits(&code[i], &code[j]))
             {
-                add_assembly_line("daddiu %s, r0, %s\n", reg1->name, ins.arg1);
-                add_assembly_line("daddiu %s, r0, %s\n", reg2->name, ins.arg2);
-
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
+                pairs[i] = (MsaPair){j, how == 2};
+                pairs[j] = (MsaPair){i, how == 1};
+                break;
             }
-            // variable = variable op variable
-            else if (is_in_data_storage(ins.result) && is_in_data_storage(ins.arg1) && is_in_data_storage(ins.arg2))
-            {
-                add_assembly_line("ld %s, %s(r0)\n", reg1->name, ins.arg1);
-                add_assembly_line("ld %s, %s(r0)\n", reg2->name, ins.arg2);
+        }
+    }
+    return pairs;
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = variable op constant
-            else if (is_in_data_storage(ins.result) && is_in_data_storage(ins.arg1) && is_digit(ins.arg2))
-            {
-                add_assembly_line("ld %s, %s(r0)\n", reg1->name, ins.arg1);
-                add_assembly_line("daddiu %s, r0, %s\n", reg2->name, ins.arg2);
+/* Fills order with every symbol index in the order .data lists them and
+   returns how many: the symbol table's order, except that with --msa the
+   variables the code would pack are chained so each lane's operand
+   follows the other's. */
+static int plan_msa_layout(int *order)
+{
+    int count = 0;
+    if (!use_msa)
+    {
+        for (int i = 0; i < symbol_count; i++)
+            order[count++] = i;
+        return count;
+    }
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = constant op variable
-            else if (is_in_data_storage(ins.result) && is_digit(ins.arg1) && is_in_data_storage(ins.arg2))
-            {
-                add_assembly_line("daddiu %s, r0, %s\n", reg1->name, ins.arg1);
-                add_assembly_line("ld %s, %s(r0)\n", reg2->name, ins.arg2);
+    for (int i = 0; i < symbol_count; i++)
+        next_in_layout[i] = prev_in_layout[i] = -1;
+    ShapeMatch *shapes = match_shapes(optimizedCode, optimizedCount);
+    free(pair_instructions(optimizedCode, optimizedCount, shapes, link_lanes));
+    free(shapes);
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = temp op temp
-            else if (is_in_data_storage(ins.result) && is_tac_temporary(ins.arg1) && is_tac_temporary(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+    for (int i = 0; i < symbol_count; i++)
+        if (prev_in_layout[i] == -1)
+            for (int v = i; v >= 0; v = next_in_layout[v])
+                order[count++] = v;
+    return count;
+}
 
-                reg1 = find_temp_reg(ins.arg1);
-                reg2 = find_temp_reg(ins.arg2);
-                reg3 = get_available_register();
+// both instructions' results from one vector instruction; x is the earlier
+static void emit_packed(TACInstruction x, TACInstruction y)
+{
+    static const char *mnemonics[] = {[TAC_ADD] = "addv.d", [TAC_SUB] = "subv.d", [TAC_MUL] = "mulv.d",
+                                      [TAC_SHL] = "slli.d", [TAC_SAR] = "srai.d", [TAC_SHR] = "srli.d"};
+    char first[64], second[64];
+
+    add_assembly_line("; msa: lanes %s, %s\n", tac_operand_text(x.result, first, sizeof(first)),
+                      tac_operand_text(y.result, second, sizeof(second)));
+    add_assembly_line("ld.d w1, %s(r0)\n", var_name(x.arg1));
+    if (tac_is_shift(x.op))
+        add_assembly_line("%s w3, w1, %d\n", mnemonics[x.op], (int)tac_const_value(x.arg2));
+    else
+    {
+        add_assembly_line("ld.d w2, %s(r0)\n", var_name(x.arg2));
+        add_assembly_line("%s w3, w1, w2\n", mnemonics[x.op]);
+    }
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = temp op variable
-            else if (is_in_data_storage(ins.result) && is_tac_temporary(ins.arg1) && is_in_data_storage(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+    if (stores_together(&x, &y))
+    {
+        add_assembly_line("st.d w3, %s(r0)\n", var_name(x.result));
+        return;
+    }
 
-                reg1 = find_temp_reg(ins.arg1);
-                reg1->used = 1;
-                reg2 = get_available_register();
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+    TACOperand results[2] = {x.result, y.result};
+    for (int lane = 0; lane < 2; lane++)
+    {
+        Register *reg = target_register(results[lane]);
+        add_assembly_line("copy_s.d %s, w3[%d]\n", reg->name, lane);
+        finish_target(results[lane], reg);
+    }
+}
 
-                add_assembly_line("ld %s, %s(r0)\n", reg2->name, ins.arg2);
+// === REGIONS ===
+/* Code is lowered a region at a time: a run of at least REGION_LENGTH
+   instructions (or the rest of the code) ending where no temporary is
+   live and no MSA pair is open. Every register is free at such a point
+   and every variable is back in memory, so regions lower independently
+   and the register allocator plans each one on its own. */
+#define REGION_LENGTH 1024
+
+/* Fills first with the index each region starts at, followed by count,
+   and returns the number of regions. first has room for count + 1. */
+static int split_regions(const TACInstruction *code, int count, int *first)
+{
+    DataflowIdSpace ids = dataflow_id_space(code, count);
+    int *last_use = malloc(sizeof(int) * (dataflow_id_count(&ids) > 0 ? dataflow_id_count(&ids) : 1));
+    if (!last_use)
+    {
+        fprintf(stderr, "Memory allocation failed in split_regions()\n");
+        exit(1);
+    }
+    for (int id = 0; id < dataflow_id_count(&ids); id++)
+        last_use[id] = -1;
+    for (int i = 0; i < count; i++)
+    {
+        int uses[2];
+        int n = dataflow_use_ids(&ids, &code[i], uses);
+        for (int k = 0; k < n; k++)
+            last_use[uses[k]] = i;
+    }
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = variable op temp
-            else if (is_in_data_storage(ins.result) && is_in_data_storage(ins.arg1) && is_tac_temporary(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+    // a packed pair is emitted at one of its instructions, so it cannot be split either
+    ShapeMatch *shapes = match_shapes(code, count);
+    MsaPair *pairs = pair_instructions(code, count, shapes, lanes_fit);
 
-                reg1 = get_available_register();
-                reg1->used = 1;
-                reg2 = find_temp_reg(ins.arg2);
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+    int regions = 0;
+    first[regions++] = 0;
+    int reach = -1; // last instruction reading a temporary defined so far
+    for (int i = 0; i + 1 < count; i++)
+    {
+        int def = dataflow_def_id(&ids, &code[i]);
+        if (def >= ids.var_count && last_use[def] > reach)
+            reach = last_use[def];
+        if (pairs && pairs[i].partner > reach)
+            reach = pairs[i].partner;
+        if (reach <= i && i + 1 - first[regions - 1] >= REGION_LENGTH)
+            first[regions++] = i + 1;
+    }
+    first[regions] = count;
 
-                add_assembly_line("ld %s, %s(r0)\n", reg1->name, ins.arg1);
+    free(pairs);
+    free(shapes);
+    free(last_use);
+    return regions;
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = temp op constant
-            else if (is_in_data_storage(ins.result) && is_tac_temporary(ins.arg1) && is_digit(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+/* Plans registers for a region: each instruction counts where its code
+   is emitted, and the variables MSA pairs load and store with ld.d/st.d
+   stay in memory. */
+static RegisterPlan plan_region(const TACInstruction *code, int count, const ShapeMatch *shapes, const MsaPair *pairs)
+{
+    int *position = malloc(sizeof(int) * (count > 0 ? count : 1));
+    char *hidden = calloc(count > 0 ? count : 1, 1);
+    char *in_memory = calloc(symbol_count > 0 ? symbol_count : 1, 1);
+    if (!position || !hidden || !in_memory)
+    {
+        fprintf(stderr, "Memory allocation failed in plan_region()\n");
+        exit(1);
+    }
 
-                reg1 = find_temp_reg(ins.arg1);
-                reg1->used = 1;
-                reg2 = get_available_register();
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+    for (int i = 0; i < count; i++)
+    {
+        position[i] = i;
+        if (shapes && shapes[i].skip)
+        {
+            position[i] = shapes[i].root;
+            hidden[i] = 1;
+        }
+        if (pairs && pairs[i].partner >= 0)
+        {
+            if (!pairs[i].emit)
+                position[i] = pairs[i].partner;
+            const TACOperand operands[3] = {code[i].result, code[i].arg1, code[i].arg2};
+            for (int k = 0; k < 3; k++)
+                if (tac_is_var(operands[k]))
+                    in_memory[tac_index(operands[k])] = 1;
+        }
+    }
 
-                add_assembly_line("daddiu %s, r0, %s\n", reg2->name, ins.arg2);
+    RegisterPlan region_plan = regalloc_plan(code, count, position, hidden, in_memory);
+    free(position);
+    free(hidden);
+    free(in_memory);
+    return region_plan;
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // variable = constant op temp
-            else if (is_in_data_storage(ins.result) && is_digit(ins.arg1) && is_tac_temporary(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+static void lower_region(const TACInstruction *code, int count)
+{
+    // temporaries die at their last use; variables stay live to the end
+    DataflowResult live = dataflow_liveness(code, count, 1);
+    ShapeMatch *shapes = match_shapes(code, count);
+    MsaPair *pairs = pair_instructions(code, count, shapes, lanes_fit);
+
+    // a temporary computed early by a pair stays in its register until it is due
+    for (int i = 0; pairs && i < count; i++)
+        if (pairs[i].emit && pairs[i].partner > i && tac_is_temp(code[pairs[i].partner].result))
+            for (int k = i; k < pairs[i].partner; k++)
+                bitset_set(&live.out[k], dataflow_operand_id(&live.ids, code[pairs[i].partner].result));
+
+    // spills pick the temporary read last
+    int *last_use = malloc(sizeof(int) * (live.ids.temp_count > 0 ? live.ids.temp_count : 1));
+    if (!last_use)
+    {
+        fprintf(stderr, "Memory allocation failed in generate_code_section()\n");
+        exit(1);
+    }
+    for (int k = 0; k < live.ids.temp_count; k++)
+        last_use[k] = -1;
+    for (int i = 0; i < count; i++)
+    {
+        const TACOperand args[2] = {code[i].arg1, code[i].arg2};
+        for (int k = 0; k < 2; k++)
+            if (tac_is_temp(args[k]))
+                last_use[tac_index(args[k])] = pairs && pairs[i].partner >= 0 && !pairs[i].emit ? pairs[i].partner : i;
+    }
+    temp_last_use = last_use;
+    frame_slots = 0;
+    int frame_at = assembly_code_count;
 
-                reg1 = get_available_register();
-                reg1->used = 1;
-                reg2 = find_temp_reg(ins.arg2);
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+    RegisterPlan region_plan;
+    initialize_registers();
+    if (use_register_allocation)
+    {
+        region_plan = plan_region(code, count, shapes, pairs);
+        plan = &region_plan;
+        first_scratch = REGALLOC_REGISTERS;
+    }
 
-                add_assembly_line("daddiu %s, r0, %s\n", reg1->name, ins.arg1);
+    for (int i = 0; i < count; i++)
+    {
+        TACInstruction ins = code[i];
+        display_tac_as_comment(ins);
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 0);
-            }
-            // temp = constant op constant
-            else if (is_tac_temporary(ins.result) && is_digit(ins.arg1) && is_digit(ins.arg2))
-            {
-                add_assembly_line("daddiu %s, r0, %s\n", reg1->name, ins.arg1);
-                add_assembly_line("daddiu %s, r0, %s\n", reg2->name, ins.arg2);
+        // part of a tree the superoptimizer's sequence computes at its root
+        if (shapes && shapes[i].skip)
+            ;
+        else if (shapes && shapes[i].entry)
+            emit_shape(&shapes[i], ins);
+        // computed in one vector instruction with its partner
+        else if (pairs && pairs[i].partner >= 0 && !pairs[i].emit)
+            ;
+        else if (pairs && pairs[i].partner > i)
+            emit_packed(ins, code[pairs[i].partner]);
+        else if (pairs && pairs[i].partner >= 0)
+            emit_packed(code[pairs[i].partner], ins);
+        else
+        {
+            const InstructionForm *form = select_form(ins);
+            form->emit(ins, form);
+        }
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = constant op temp
-            else if (is_tac_temporary(ins.result) && is_digit(ins.arg1) && is_tac_temporary(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+        release_dead_temps(&live, i);
+        release_ended_intervals(i);
+        fetched = 0;
+        add_assembly_line("\n");
+    }
 
-                reg1 = get_available_register();
-                reg1->used = 1;
-                reg2 = find_temp_reg(ins.arg2);
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+    if (frame_slots > 0)
+    {
+        insert_assembly_line(frame_at, "daddiu sp, sp, -%d\n", 8 * frame_slots);
+        add_assembly_line("daddiu sp, sp, %d\n", 8 * frame_slots);
+        add_assembly_line("\n");
+    }
+    temp_last_use = NULL;
+    free(last_use);
 
-                add_assembly_line("daddiu %s, r0, %s\n", reg1->name, ins.arg1);
+    if (plan)
+    {
+        regalloc_free(&region_plan);
+        plan = NULL;
+        first_scratch = 0;
+    }
+    free(pairs);
+    free(shapes);
+    dataflow_free_result(&live);
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = temp op constant
-            else if (is_tac_temporary(ins.result) && is_tac_temporary(ins.arg1) && is_digit(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+static void lower_regions(const TACInstruction *code, const int *first, int from, int to)
+{
+    for (int r = from; r < to; r++)
+        lower_region(code + first[r], first[r + 1] - first[r]);
+}
 
-                reg1 = find_temp_reg(ins.arg1);
-                reg1->used = 1;
-                reg2 = get_available_register();
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+// the instructions for code, without the .code header
+static void generate_code_lines(const TACInstruction *code, int count)
+{
+    int *first = malloc(sizeof(int) * (count + 1));
+    if (!first)
+    {
+        fprintf(stderr, "Memory allocation failed in generate_code_section()\n");
+        exit(1);
+    }
+    int regions = split_regions(code, count, first);
+    lower_regions(code, first, 0, regions);
+    free(first);
+}
 
-                add_assembly_line("daddiu %s, r0, %s\n", reg2->name, ins.arg2);
+// === PARALLEL LOWERING ===
+typedef struct
+{
+    const TACInstruction *code;
+    const int *first;          // region starts, as split_regions() gives them
+    int from[MAX_JOBS + 1];    // slot k lowers regions from[k] .. from[k + 1] - 1
+    ASSEMBLY *lines[MAX_JOBS]; // copied out of the worker's own assembly_code
+    int line_count[MAX_JOBS];
+} LoweringJob;
+
+static void lower_range(int slot, void *arg)
+{
+    LoweringJob *job = arg;
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = constant op variable
-            else if (is_tac_temporary(ins.result) && is_digit(ins.arg1) && is_in_data_storage(ins.arg2))
-            {
-                add_assembly_line("daddiu %s, r0, %s\n", reg1->name, ins.arg1);
-                add_assembly_line("ld %s, %s(r0)\n", reg2->name, ins.arg2);
+    assembly_code_count = 0;
+    lower_regions(job->code, job->first, job->from[slot], job->from[slot + 1]);
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = variable op constant
-            else if (is_tac_temporary(ins.result) && is_in_data_storage(ins.arg1) && is_digit(ins.arg2))
-            {
-                add_assembly_line("ld %s, %s(r0)\n", reg1->name, ins.arg1);
-                add_assembly_line("daddiu %s, r0, %s\n", reg2->name, ins.arg2);
+    job->lines[slot] = malloc(sizeof(ASSEMBLY) * (assembly_code_count > 0 ? assembly_code_count : 1));
+    if (!job->lines[slot])
+    {
+        fprintf(stderr, "Memory allocation failed in lower_range()\n");
+        exit(1);
+    }
+    memcpy(job->lines[slot], assembly_code, sizeof(ASSEMBLY) * assembly_code_count);
+    job->line_count[slot] = assembly_code_count;
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = variable op variable
-            else if (is_tac_temporary(ins.result) && is_in_data_storage(ins.arg1) && is_in_data_storage(ins.arg2))
-            {
-                add_assembly_line("ld %s, %s(r0)\n", reg1->name, ins.arg1);
-                add_assembly_line("ld %s, %s(r0)\n", reg2->name, ins.arg2);
+/* Hands whole regions to the workers, so the lines are the ones the
+   serial loop would give whatever the number of jobs. */
+static void generate_code_lines_parallel(const TACInstruction *code, int count)
+{
+    LoweringJob *job = calloc(1, sizeof(LoweringJob));
+    int *first = malloc(sizeof(int) * (count + 1));
+    if (!job || !first)
+    {
+        fprintf(stderr, "Memory allocation failed in generate_code_section()\n");
+        exit(1);
+    }
+    job->code = code;
+    job->first = first;
+    int regions = split_regions(code, count, first);
+    int slots = job_count() < regions ? job_count() : regions;
+    for (int k = 0; k <= slots; k++)
+        job->from[k] = (int)((long long)regions * k / slots);
+    parallel_run(slots, lower_range, job);
+
+    for (int k = 0; k < slots; k++)
+    {
+        for (int i = 0; i < job->line_count[k]; i++)
+            add_assembly_line("%s", job->lines[k][i].assembly);
+        free(job->lines[k]);
+    }
+    free(first);
+    free(job);
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = temp op variable
-            else if (is_tac_temporary(ins.result) && is_tac_temporary(ins.arg1) && is_in_data_storage(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+// === MEMORY FORWARDING ===
+/* A pass over finished straight-line code that follows, for each
+   register, the variable whose memory value it still holds. A load of a
+   variable some register holds becomes a move (or goes, if it is that
+   register); a store of the value memory already has goes; and a store
+   that a later one overwrites before anything reads the slot goes.
+   MSA loads and stores cover two slots, so they end the tracking. */
+#define FORWARD_REGISTERS 32
+#define FORWARD_FIELD 64 // room for any label with its "(r0)"
+
+typedef struct
+{
+    char label[MAX_DATA_LENGTH]; // "" for an unused entry
+    int pending_store;           // line of the last store nothing has read back from memory, -1 if none
+} ForwardSlot;
 
-                reg1 = find_temp_reg(ins.arg1);
-                reg1->used = 1;
-                reg2 = get_available_register();
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+typedef struct
+{
+    ForwardSlot *slot; // open addressing on the label
+    int mask;
+    int holds[FORWARD_REGISTERS]; // per register: the slot whose memory value it has, -1 if none
+} ForwardState;
 
-                add_assembly_line("ld %s, %s(r0)\n", reg2->name, ins.arg2);
+void set_memory_forwarding(int on)
+{
+    use_memory_forwarding = on;
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = variable op temp
-            else if (is_tac_temporary(ins.result) && is_in_data_storage(ins.arg1) && is_tac_temporary(ins.arg2))
-            {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
+static int forward_register(const char *name)
+{
+    if (strcmp(name, "sp") == 0)
+        return 29;
+    return name[0] == 'r' ? atoi(name + 1) : -1;
+}
 
-                reg1 = get_available_register();
-                reg1->used = 1;
-                reg2 = find_temp_reg(ins.arg2);
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
+// the slot for "label(r0)", or -1 when the address is not a variable's
+static int forward_slot(ForwardState *f, const char *address)
+{
+    const char *paren = strchr(address, '(');
+    if (!paren || strcmp(paren, "(r0)") != 0 || paren - address >= MAX_DATA_LENGTH || paren == address)
+        return -1;
+
+    int length = (int)(paren - address);
+    unsigned int hash = 2166136261u;
+    for (int k = 0; k < length; k++)
+        hash = (hash ^ (unsigned char)address[k]) * 16777619u;
+    for (int n = hash & f->mask;; n = (n + 1) & f->mask)
+    {
+        ForwardSlot *s = &f->slot[n];
+        if (!s->label[0])
+        {
+            memcpy(s->label, address, length);
+            s->label[length] = '\0';
+            s->pending_store = -1;
+            return n;
+        }
+        if ((int)strlen(s->label) == length && strncmp(s->label, address, length) == 0)
+            return n;
+    }
+}
 
-                add_assembly_line("ld %s, %s(r0)\n", reg1->name, ins.arg1);
+// splits "mnemonic a, b, c" into field[0 .. 3]; sscanf would cost the pass more than the rest of its work
+static int split_instruction(const char *line, char field[4][FORWARD_FIELD])
+{
+    int n = 0;
+    while (n < 4 && *line && *line != '\n')
+    {
+        int length = 0;
+        for (; *line && *line != '\n' && *line != ',' && !(n == 0 && *line == ' '); line++)
+            if (length < FORWARD_FIELD - 1)
+                field[n][length++] = *line;
+        field[n++][length] = '\0';
+        while (*line == ',' || *line == ' ')
+            line++;
+    }
+    for (int k = n; k < 4; k++)
+        field[k][0] = '\0';
+    return n;
+}
 
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
-            }
-            // temp = temp op temp
-            else if (is_tac_temporary(ins.result) && is_tac_temporary(ins.arg1) && is_tac_temporary(ins.arg2))
+static void forget_register(ForwardState *f, int reg)
+{
+    if (reg > 0 && reg < FORWARD_REGISTERS)
+        f->holds[reg] = -1;
+}
+
+// rewrites assembly_code[from ..), dropping the lines it makes redundant
+static void forward_memory(int from)
+{
+    int accesses = 0;
+    for (int i = from; i < assembly_code_count; i++)
+        if (strstr(assembly_code[i].assembly, "(r0)"))
+            accesses++;
+    if (accesses == 0)
+        return;
+
+    ForwardState f;
+    int capacity = 16;
+    while (capacity < 2 * accesses)
+        capacity *= 2;
+    f.slot = calloc(capacity, sizeof(ForwardSlot));
+    if (!f.slot)
+    {
+        fprintf(stderr, "Memory allocation failed in forward_memory()\n");
+        exit(1);
+    }
+    f.mask = capacity - 1;
+    for (int r = 0; r < FORWARD_REGISTERS; r++)
+        f.holds[r] = -1;
+
+    for (int i = from; i < assembly_code_count; i++)
+    {
+        char *line = assembly_code[i].assembly;
+        char field[4][FORWARD_FIELD];
+        if (line[0] == ';' || split_instruction(line, field) == 0)
+            continue;
+        const char *mnemonic = field[0], *first = field[1], *second = field[2], *third = field[3];
+
+        if (strchr(mnemonic, '.'))
+        {
+            // ld.d and st.d read or write the slot after the one named as well
+            if (strstr(second, "(r0)"))
             {
-                reg1->used = 0;
-                reg2->used = 0;
-                reg3->used = 0;
-
-                reg1 = find_temp_reg(ins.arg1);
-                reg1->used = 1;
-                reg2 = find_temp_reg(ins.arg2);
-                reg2->used = 1;
-                reg3 = get_available_register();
-                reg3->used = 1;
-
-                perform_operation(ins.result, ins.arg1, ins.op, ins.arg2, reg1, reg2, reg3, 1);
+                for (int n = 0; n < capacity; n++)
+                    f.slot[n].pending_store = -1;
+                if (strcmp(mnemonic, "st.d") == 0)
+                    for (int r = 0; r < FORWARD_REGISTERS; r++)
+                        f.holds[r] = -1;
             }
+            // of the MSA instructions only copy_s.d writes a general register
+            if (strcmp(mnemonic, "copy_s.d") == 0)
+                forget_register(&f, forward_register(first));
+            continue;
         }
 
-        add_assembly_line("\n");
+        int reg = forward_register(first);
+        int slot = strcmp(mnemonic, "ld") == 0 || strcmp(mnemonic, "sd") == 0 ? forward_slot(&f, second) : -1;
+        if (slot >= 0 && strcmp(mnemonic, "ld") == 0)
+        {
+            int holder = -1;
+            for (int r = 0; r < FORWARD_REGISTERS && holder < 0; r++)
+                if (f.holds[r] == slot)
+                    holder = r;
+
+            if (holder == reg)
+                line[0] = '\0';
+            else if (holder >= 0)
+                snprintf(line, MAX_ASSEMBLY_LINE, "daddu %s, r%d, r0\n", first, holder);
+            else
+                f.slot[slot].pending_store = -1;
+            if (reg > 0 && reg < FORWARD_REGISTERS)
+                f.holds[reg] = slot;
+        }
+        else if (slot >= 0)
+        {
+            if (reg >= 0 && reg < FORWARD_REGISTERS && f.holds[reg] == slot)
+            {
+                line[0] = '\0'; // memory has this value already
+                continue;
+            }
+            if (f.slot[slot].pending_store >= 0)
+                assembly_code[f.slot[slot].pending_store].assembly[0] = '\0';
+            f.slot[slot].pending_store = i;
+            for (int r = 0; r < FORWARD_REGISTERS; r++)
+                if (f.holds[r] == slot)
+                    f.holds[r] = -1;
+            if (reg >= 0 && reg < FORWARD_REGISTERS)
+                f.holds[reg] = slot;
+        }
+        // a move copies what its source holds
+        else if (strcmp(mnemonic, "daddu") == 0 && strcmp(third, "r0") == 0 && reg > 0 && reg < FORWARD_REGISTERS)
+        {
+            int source = forward_register(second);
+            f.holds[reg] = source >= 0 && source < FORWARD_REGISTERS ? f.holds[source] : -1;
+        }
+        // dmult and ddiv write hi/lo, and stores only memory; everything else writes its first operand
+        else if (strcmp(mnemonic, "sd") != 0 && strcmp(mnemonic, "dmult") != 0 && strcmp(mnemonic, "ddiv") != 0)
+            forget_register(&f, reg);
     }
+    free(f.slot);
+
+    int kept = from;
+    for (int i = from; i < assembly_code_count; i++)
+        if (assembly_code[i].assembly[0])
+            assembly_code[kept++] = assembly_code[i];
+    assembly_code_count = kept;
+}
+
+void generate_code_section()
+{
+    add_assembly_line("\n.code\n");
+    int code_start = assembly_code_count;
+    if (job_count() > 1 && optimizedCount > REGION_LENGTH)
+        generate_code_lines_parallel(optimizedCode, optimizedCount);
+    else
+        generate_code_lines(optimizedCode, optimizedCount);
+    if (use_memory_forwarding)
+        forward_memory(code_start);
 }
 
 void output_assembly_file()
@@ -593,10 +1724,93 @@ void output_assembly_file()
 
 void generate_target_code()
 {
+    regalloc_order_trees(optimizedCode, optimizedCount);
     initialize_registers();
     generate_data_section();
+    generate_constant_pool();
     generate_code_section();
+    free(pool_slot);
+    pool_slot = NULL;
     // display_data_storage();
     display_assembly_code();
     output_assembly_file();
-}
\ No newline at end of file
+}
+
+void generate_evaluated_target_code(const long long *values)
+{
+    initialize_registers();
+    initial_values = values;
+    generate_data_section();
+    initial_values = NULL;
+    add_assembly_line("\n.code\n");
+    add_assembly_line("\n"); // nothing left to run
+    display_assembly_code();
+    output_assembly_file();
+}
+
+// === STREAMING ===
+void generate_statement_target_code(const TACInstruction *code, int count, FILE *out)
+{
+    // values live in memory between statements, so every register starts free
+    TACInstruction *ordered = malloc(sizeof(TACInstruction) * (count > 0 ? count : 1));
+    if (!ordered)
+    {
+        fprintf(stderr, "Memory allocation failed in generate_statement_target_code()\n");
+        exit(1);
+    }
+    memcpy(ordered, code, sizeof(TACInstruction) * count);
+    regalloc_order_trees(ordered, count);
+
+    assembly_code_count = 0;
+    generate_code_lines(ordered, count);
+    free(ordered);
+    if (use_memory_forwarding)
+        forward_memory(0);
+
+    for (int i = 0; i < assembly_code_count; i++)
+        fputs(assembly_code[i].assembly, out);
+}
+
+int write_streamed_assembly(const int *order, int count, FILE *code)
+{
+    FILE *file = fopen("output_assembly.txt", "w");
+    if (!file)
+    {
+        printf("Error: Unable to create output_assembly.txt\n");
+        return 1;
+    }
+
+    fprintf(file, ".data\n");
+    char listed[MAX_SYMBOLS] = {0};
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(file, "%s: .word64 0\n", symbol_table[order[i]].name);
+        listed[order[i]] = 1;
+    }
+    // after the used ones, so the addresses the code was encoded with stay put
+    for (int i = 0; i < symbol_count && keep_all_data; i++)
+        if (!listed[i])
+            fprintf(file, "%s: .word64 0\n", symbol_table[i].name);
+    fprintf(file, "\n.code\n");
+
+    // copied a block at a time, holding back a final newline as output_assembly_file() does
+    char block[4096];
+    size_t n;
+    int pending = 0;
+    rewind(code);
+    while ((n = fread(block, 1, sizeof(block), code)) > 0)
+    {
+        if (pending)
+            fputc('\n', file);
+        pending = block[n - 1] == '\n';
+        fwrite(block, 1, pending ? n - 1 : n, file);
+    }
+
+    if (fclose(file) != 0)
+    {
+        printf("Error: Unable to write output_assembly.txt\n");
+        return 1;
+    }
+    printf(">>Assembly code successfully written to output_assembly.txt\n\n");
+    return 0;
+}